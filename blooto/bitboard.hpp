@@ -198,6 +198,10 @@ namespace blooto {
         //! @return true if bitboard contains no squares
         constexpr bool empty() const {return data_ == 0ULL;}
 
+        //! Count squares in BitBoard
+        //! @return number of squares the bitboard contains
+        unsigned count() const {return BitScan::popcount(data_);}
+
     private:
         data_type data_;
 
@@ -37,6 +37,23 @@ namespace blooto {
 
         constexpr static const std::uint64_t debruijn64 = 0x03f79d71b4cb0a89ULL;
 
+        // Sum bits in pairs, nibbles and then bytes of the number
+        constexpr static std::uint64_t count2(std::uint64_t data) {
+            return data - ((data >> 1) & 0x5555555555555555ULL);
+        }
+
+        constexpr static std::uint64_t count4(std::uint64_t data) {
+            return
+                (data & 0x3333333333333333ULL) +
+                ((data >> 2) & 0x3333333333333333ULL);
+        }
+
+        constexpr static unsigned count8(std::uint64_t data) {
+            return
+                (((data + (data >> 4)) & 0x0f0f0f0f0f0f0f0fULL) *
+                 0x0101010101010101ULL) >> 56;
+        }
+
     public:
         //! Find least significant one bit in 64-bit number
         //! @author Kim Walisch (2012)
@@ -46,10 +63,19 @@ namespace blooto {
         constexpr static unsigned ls1b(std::uint64_t data) {
             return index64[((data ^ (data-1)) * debruijn64) >> 58];
         }
+
+        //! Count one bits in 64-bit number
+        //! @param data 64-bit number to count bits in
+        //! @return number (0..64) of one bits
+        //! This algorithm sums bits in parallel ("SWAR" population count).
+        constexpr static unsigned popcount(std::uint64_t data) {
+            return count8(count4(count2(data)));
+        }
     };
 
 #if defined(BOOST_MSVC) && defined(_M_X64)
 #pragma intrinsic(_BitScanForward64)
+#pragma intrinsic(__popcnt64)
 
     // TODO: Untested! Somebody please test with MSVC
     // and remove this comment if test is successful.
@@ -66,6 +92,14 @@ namespace blooto {
             _BitScanForward64(&result, mask);
             return result;
         }
+
+        //! Count one bits in 64-bit number
+        //! @param data 64-bit number to count bits in
+        //! @return number (0..64) of one bits
+        //! This algorithm uses __popcnt64 intrinsic to count bits.
+        static unsigned popcount(std::uint64_t data) {
+            return unsigned(__popcnt64(data));
+        }
     };
 
     struct BitScanOptimised: BitScanMSVC {};
@@ -83,6 +117,14 @@ namespace blooto {
         constexpr static unsigned ls1b(std::uint64_t data) {
             return __builtin_ctzll(data);
         }
+
+        //! Count one bits in 64-bit number
+        //! @param data 64-bit number to count bits in
+        //! @return number (0..64) of one bits
+        //! This algorithm uses __builtin_popcountll intrinsic to count bits.
+        constexpr static unsigned popcount(std::uint64_t data) {
+            return __builtin_popcountll(data);
+        }
     };
 
     struct BitScanOptimised: BitScanGCC {};
@@ -36,9 +36,11 @@
 #include <boost/mpl/bool.hpp>
 #include <boost/mpl/fold.hpp>
 #include <boost/mpl/placeholders.hpp>
+#include <boost/variant.hpp>
 
 #include <blooto/square.hpp>
 #include <blooto/bitboard.hpp>
+#include <blooto/magicmoves.hpp>
 #include <blooto/piecetype.hpp>
 #include <blooto/pawntype.hpp>
 #include <blooto/bishoptype.hpp>
@@ -49,6 +51,9 @@
 #include <blooto/piece.hpp>
 #include <blooto/colour.hpp>
 #include <blooto/move.hpp>
+#include <blooto/packedmove.hpp>
+#include <blooto/movelist.hpp>
+#include <blooto/zobrist.hpp>
 
 namespace blooto {
 
@@ -69,7 +74,8 @@ namespace blooto {
                                                            PT>::type>;
 
         template <typename PT, typename N> using piece_bit =
-            boost::mpl::bool_<((1 << N::value) & piece_code<PT>::value)>;
+            boost::mpl::bool_<
+                (((1 << N::value) & piece_code<PT>::value) != 0)>;
 
         template <typename NB, typename N> struct find_nb:
         boost::mpl::if_<boost::mpl::bool_<((1 << NB::value) < N::value)>,
@@ -100,6 +106,7 @@ namespace blooto {
             }
             piececode_t get(Square square) const {return 0;}
             void move(Square, Square) {}
+            bool equal(const bb_storage_base &, BitBoard) const {return true;}
         };
 
         template <typename Base, typename N>
@@ -149,6 +156,11 @@ namespace blooto {
                 set_internal(value_[from], BitBoard{to});
                 Base::move(from, to);
             }
+            bool equal(const bb_storage_unit &other, BitBoard mask) const {
+                return
+                    (value_ & mask) == (other.value_ & mask) &&
+                    Base::equal(other, mask);
+            }
         };
 
         using bb_storage =
@@ -200,6 +212,184 @@ namespace blooto {
             }
         };
 
+        using zobrist = Zobrist<(1 << bb_size::value)>;
+
+        static_assert((1 << bb_size::value) <= PackedMove::promotion_codes,
+                      "piece codes must fit into packed moves");
+        static_assert(piece_code<PawnType>::value == 0,
+                      "packed moves use code 0 for no promotion");
+
+        // Squares from which piece of type PT moving in given colour
+        // can capture at the square. All piece types except pawns
+        // move symmetrically, and pawns capture backwards relative
+        // to pawns of opposite colour.
+        // Colour may be either MoveColour or colour tag
+        // known at compile time.
+        template <typename PT, typename C>
+        static BitBoard reverse_captures(const PT &pt, C colour,
+                                         Square square, BitBoard occupancy)
+        {
+            return pt.PT::moves(colour, square, occupancy);
+        }
+
+        template <typename C>
+        static BitBoard reverse_captures(const PawnType &pt, C colour,
+                                         Square square, BitBoard)
+        {
+            return pt.moves(opposite(colour), square, ~BitBoard{});
+        }
+
+        // Squares where piece of type PT moving in given colour
+        // from the square can capture. Pawns capture only diagonally.
+        template <typename PT, typename C>
+        static BitBoard captures(const PT &pt, C colour,
+                                 Square square, BitBoard occupancy)
+        {
+            return pt.PT::moves(colour, square, occupancy);
+        }
+
+        template <typename C>
+        static BitBoard captures(const PawnType &pt, C colour,
+                                 Square square, BitBoard)
+        {
+            return pt.moves(colour, square, ~BitBoard{});
+        }
+
+        template <typename C> class attacks_base {
+            const Board &board_;
+            const BitBoard pieces_;
+            const C colour_;
+            const BitBoard occupancy_;
+        public:
+            attacks_base(const Board &board, BitBoard pieces,
+                         C colour, BitBoard occupancy)
+            : board_(board), pieces_{pieces}, colour_{colour}
+            , occupancy_{occupancy} {}
+            const Board &board() const {return board_;}
+            BitBoard pieces() const {return pieces_;}
+            const C &colour() const {return colour_;}
+            BitBoard occupancy() const {return occupancy_;}
+            BitBoard operator()() const {return BitBoard{};}
+        };
+
+        template <typename Base, typename PT>
+        struct attacks_unit: Base {
+            using Base::Base;
+            BitBoard operator()() const {
+                BitBoard result{Base::operator()()};
+                for (Square square: Base::pieces() &
+                                    Base::board().template pieces<PT>())
+                {
+                    result |= captures(PT::instance, Base::colour(),
+                                       square, Base::occupancy());
+                }
+                return result;
+            }
+        };
+
+        template <typename C>
+        using attacks_func =
+            typename boost::mpl::fold<piecetypes_t,
+                                      attacks_base<C>,
+                                      attacks_unit<boost::mpl::_1,
+                                                   boost::mpl::_2>>::type;
+
+        template <typename C> class attackers_base {
+            const Board &board_;
+            const Square square_;
+            const C colour_;
+            const BitBoard occupancy_;
+        public:
+            attackers_base(const Board &board, Square square,
+                           C colour, BitBoard occupancy)
+            : board_(board), square_{square}, colour_{colour}
+            , occupancy_{occupancy} {}
+            const Board &board() const {return board_;}
+            Square square() const {return square_;}
+            const C &colour() const {return colour_;}
+            BitBoard occupancy() const {return occupancy_;}
+            BitBoard operator()() const {return BitBoard{};}
+        };
+
+        template <typename Base, typename PT>
+        struct attackers_unit: Base {
+            using Base::Base;
+            BitBoard operator()() const {
+                return
+                    (reverse_captures(PT::instance, Base::colour(),
+                                      Base::square(), Base::occupancy()) &
+                     Base::board().template pieces<PT>()) |
+                    Base::operator()();
+            }
+        };
+
+        template <typename C>
+        using attackers_func =
+            typename boost::mpl::fold<piecetypes_t,
+                                      attackers_base<C>,
+                                      attackers_unit<boost::mpl::_1,
+                                                     boost::mpl::_2>>::type;
+
+        // Call function object with the instance of piece type
+        // having given code, so that the type is known at compile time
+        template <typename Func> class dispatch_base {
+            const Func &func_;
+            const piececode_t code_;
+        public:
+            using result_type = typename Func::result_type;
+            dispatch_base(const Func &func, piececode_t code)
+            : func_(func), code_{code} {}
+            const Func &func() const {return func_;}
+            piececode_t code() const {return code_;}
+            result_type operator()() const {return result_type{};}
+        };
+
+        template <typename Base, typename PT>
+        struct dispatch_unit: Base {
+            using Base::Base;
+            typename Base::result_type operator()() const {
+                if (Base::code() == piece_code<PT>::value)
+                    return Base::func()(PT::instance);
+                return Base::operator()();
+            }
+        };
+
+        template <typename Func>
+        using dispatch_func =
+            typename boost::mpl::fold<piecetypes_t,
+                                      dispatch_base<Func>,
+                                      dispatch_unit<boost::mpl::_1,
+                                                    boost::mpl::_2>>::type;
+
+        template <typename Func>
+        static typename Func::result_type dispatch(piececode_t code,
+                                                   const Func &func)
+        {
+            return dispatch_func<Func>{func, code}();
+        }
+
+        // Moves of a piece from the square
+        template <typename C> struct moves_op {
+            using result_type = BitBoard;
+            C colour;
+            Square square;
+            BitBoard occupancy;
+            template <typename PT> BitBoard operator()(const PT &pt) const {
+                return pt.moves(colour, square, occupancy);
+            }
+        };
+
+        // Squares where a piece gives direct check to the king
+        template <typename C> struct check_squares_op {
+            using result_type = BitBoard;
+            C colour;
+            Square king;
+            BitBoard occupancy;
+            template <typename PT> BitBoard operator()(const PT &pt) const {
+                return reverse_captures(pt, colour, king, occupancy);
+            }
+        };
+
         class Proxy {
             const Board &board_;
         public:
@@ -207,19 +397,182 @@ namespace blooto {
             constexpr const Board &board() const {return board_;}
         };
 
-        MoveColour colour_;
+        // Move colour as zobrist::white or zobrist::black
+        unsigned colour_;
         bb_storage pieces_;
         BitBoard friendlies_or_neutral_;
         BitBoard unfriendlies_or_neutral_;
+        std::uint64_t hash_;
+
+        // MoveColour alternatives are ordered the same way
+        // as zobrist::white and zobrist::black
+        static unsigned colour_index(MoveColour colour) {
+            return colour.which();
+        }
+
+        static std::uint64_t colour_key(MoveColour colour) {
+            return
+                colour_index(colour) == zobrist::white ? 0 : zobrist::colour();
+        }
+
+        // Index of the colour opposite to move colour
+        unsigned opposite_colour() const {
+            return colour_ == zobrist::white ? zobrist::black : zobrist::white;
+        }
+
+        // Add or remove key of the piece at the square (if any) to the hash
+        void hash_square(Square square) {
+            if (!occupied()[square])
+                return;
+            unsigned colour =
+                neutrals()[square] ? zobrist::neutral :
+                friendlies()[square] ? colour_ : opposite_colour();
+            hash_ ^= zobrist::piece(pieces_.get(square), colour, square);
+        }
+
+        // Update the hash and the colours of the squares for a move
+        // of friendly or neutral piece with given code, which becomes
+        // the piece with code promoted, capturing the piece with code
+        // captured if capture is set; the pieces are not decoded,
+        // as their codes are known, and piece codes are left to caller
+        void move_piece(Square from, Square to, bool neutral,
+                        piececode_t code, piececode_t promoted,
+                        bool capture, piececode_t captured,
+                        bool captured_neutral)
+        {
+            const unsigned colour{neutral ? zobrist::neutral : colour_};
+            hash_ ^= zobrist::piece(code, colour, from) ^
+                     zobrist::piece(promoted, colour, to);
+            if (capture)
+                hash_ ^= zobrist::piece(captured,
+                                        captured_neutral ? zobrist::neutral :
+                                                           opposite_colour(),
+                                        to);
+            friendlies_or_neutral_ &= ~from;
+            friendlies_or_neutral_ |= to;
+            unfriendlies_or_neutral_ &= ~(from | to);
+            if (neutral)
+                unfriendlies_or_neutral_ |= to;
+        }
+
+        // Append moves of friendly and then neutral pieces of every type
+        // to target squares (only checking ones if requested);
+        // piece types are gone through at compile time, so the moves
+        // of every piece are computed without dispatching its code
+        template <typename C> class generate_base {
+            const Board &board_;
+            MoveList &list_;
+            const C colour_;
+            const BitBoard occupancy_;
+            const BitBoard targets_;
+            const BitBoard kings_;
+            const bool checks_;
+        public:
+            generate_base(const Board &board, MoveList &list, C colour,
+                          BitBoard targets, bool checks)
+            : board_(board), list_(list), colour_{colour}
+            , occupancy_{board.occupied()}
+            , targets_{targets & ~board.friendlies()}
+            , kings_{checks ? board.pieces<KingType>() & board.unfriendlies() :
+                              BitBoard{}}
+            , checks_{checks} {}
+            const Board &board() const {return board_;}
+            const C &colour() const {return colour_;}
+            BitBoard occupancy() const {return occupancy_;}
+            BitBoard targets() const {return targets_;}
+
+            // Append moves of the piece of type PT from the square
+            template <typename PT>
+            void append(const PT &pt, Square from, BitBoard moves) const {
+                BitBoard direct_checks;
+                for (Square king: kings_)
+                    direct_checks |=
+                        reverse_captures(pt, colour_, king,
+                                         occupancy_ & ~from);
+                for (Square to: moves) {
+                    bool discovered{false};
+                    for (Square king: kings_)
+                        if (board_.discovers_check(from, to, king))
+                            discovered = true;
+                    const bool attack{occupancy_[to]};
+                    if (pt.can_be_promoted(colour_, to)) {
+                        for (auto p = promotions().begin();
+                             p != promotions().end(); ++p)
+                        {
+                            bool check{!checks_ || discovered};
+                            for (Square king: kings_)
+                                if (board_.check_squares(*p, from, king)[to])
+                                    check = true;
+                            if (check)
+                                list_.push_back(PackedMove{from, to, attack,
+                                                           p.code()});
+                        }
+                    } else if (!checks_ || discovered || direct_checks[to]) {
+                        list_.push_back(PackedMove{from, to, attack});
+                    }
+                }
+            }
+
+            // Append moves of the pieces of type PT
+            template <typename PT>
+            void append(const PT &pt, BitBoard pieces) const {
+                for (Square from: pieces)
+                    append(pt, from,
+                           pt.PT::moves(colour_, from, occupancy_) &
+                           targets_);
+            }
+
+            // Pawn moves are computed for all pawns at once
+            void append(const PawnType &pt, BitBoard pawns) const {
+                const PawnType::Moves<C> moves{colour_, pawns, occupancy_,
+                                               targets_};
+                for (Square from: moves.origins())
+                    append(pt, from, moves.from(from));
+            }
+
+            void operator()() const {}
+        };
+
+        template <typename Base, typename PT>
+        struct generate_unit: Base {
+            using Base::Base;
+            void operator()() const {
+                const BitBoard pieces{Base::board().template pieces<PT>()};
+                Base::append(PT::instance,
+                             pieces & Base::board().friendlies());
+                Base::append(PT::instance,
+                             pieces & Base::board().neutrals());
+                Base::operator()();
+            }
+        };
+
+        template <typename C>
+        using generate_func =
+            typename boost::mpl::fold<piecetypes_t,
+                                      generate_base<C>,
+                                      generate_unit<boost::mpl::_1,
+                                                    boost::mpl::_2>>::type;
+
+        void generate_moves(MoveList &list, BitBoard targets,
+                            bool checks) const
+        {
+            if (colour_ == zobrist::white)
+                generate_func<ColourWhite>{*this, list, ColourWhite(),
+                                           targets, checks}();
+            else
+                generate_func<ColourBlack>{*this, list, ColourBlack(),
+                                           targets, checks}();
+        }
 
     public:
 
         //! Construct empty board
-        Board(): colour_{ColourWhite()} {}
+        Board(): colour_{zobrist::white}, hash_{0} {}
 
         //! Construct empty board with specified move colour
         //! @param colour colour for the next move
-        Board(MoveColour colour): colour_{colour} {}
+        Board(MoveColour colour)
+        : colour_{colour_index(colour)}, hash_{colour_key(colour)} {}
 
         //! Default copy constructor
         //! @param other board to construct from
@@ -232,7 +585,7 @@ namespace blooto {
         //! Construct board from list of pieces
         //! @param pieces list of pieces
         Board(const std::initializer_list<Piece> &pieces)
-        : colour_{ColourWhite()}
+        : colour_{zobrist::white}, hash_{0}
         {
             for (const auto &p: pieces)
                 insert(p);
@@ -242,7 +595,7 @@ namespace blooto {
         //! @param colour colour for the next move
         //! @param pieces list of pieces
         Board(MoveColour colour, const std::initializer_list<Piece> &pieces)
-        : colour_{colour}
+        : colour_{colour_index(colour)}, hash_{colour_key(colour)}
         {
             for (const auto &p: pieces)
                 insert(p);
@@ -250,21 +603,57 @@ namespace blooto {
 
         //! Move colour access method
         //! @return current move colour
-        MoveColour colour() const {return colour_;}
+        MoveColour colour() const {
+            if (colour_ == zobrist::white)
+                return ColourWhite();
+            return ColourBlack();
+        }
+
+        //! Check whether white is to move
+        //! @return true if white is to move, false if black is
+        //! This is cheaper than inspecting colour().
+        bool white_to_move() const {return colour_ == zobrist::white;}
+
+        //! Zobrist hash of this board
+        //! @return 64-bit hash of pieces and move colour
+        //! Boards containing the same pieces with the same move colour
+        //! have equal hashes.
+        //! The hash is updated incrementally by every method
+        //! modifying the board, so this method is cheap.
+        std::uint64_t hash() const {return hash_;}
+
+        //! Compare with other board for equality
+        //! @param rhs other board
+        //! @return true if both boards have the same pieces and move colour
+        bool operator==(const Board &rhs) const {
+            return
+                hash_ == rhs.hash_ &&
+                colour_ == rhs.colour_ &&
+                friendlies_or_neutral_ == rhs.friendlies_or_neutral_ &&
+                unfriendlies_or_neutral_ == rhs.unfriendlies_or_neutral_ &&
+                pieces_.equal(rhs.pieces_, occupied());
+        }
+
+        //! Compare with other board for inequality
+        //! @param rhs other board
+        //! @return true if boards differ in pieces or move colour
+        bool operator!=(const Board &rhs) const {return !(*this == rhs);}
 
         //! Add a piece to this board
         //! @param piece piece to add
         void insert(const Piece &piece) {
+            hash_square(piece.square());
             pieces_.set(PieceTypeCodes::get(piece.piecetype()),
                         BitBoard{piece.square()});
-            if (colour_.friendly(piece.colour()))
+            if (colour().friendly(piece.colour()))
                 unfriendlies_or_neutral_ &= ~piece.square();
             else
                 unfriendlies_or_neutral_ |= piece.square();
-            if (colour_.can_move(piece.colour()))
+            if (colour().can_move(piece.colour()))
                 friendlies_or_neutral_ |= piece.square();
             else
                 friendlies_or_neutral_ &= ~piece.square();
+            hash_square(piece.square());
         }
 
         //! Type of pice at the square
@@ -282,9 +671,9 @@ namespace blooto {
         //! Behaviour is undefined is there is no piece at that square!
         Piece operator[](Square square) const {
             return Piece(square, *piecetype(square),
-                         friendlies()[square] ? colour_.to_piece_colour() :
+                         friendlies()[square] ? colour().to_piece_colour() :
                          can_move()[square] ? PieceColour(ColourNeutral()) :
-                         colour_.opposite().to_piece_colour());
+                         colour().opposite().to_piece_colour());
         }
 
         //! Check whether unfriendly king is at the square
@@ -300,6 +689,8 @@ namespace blooto {
         //! @param from source square where the piece to be moved is located
         //! @param to destination square where the piece to be moved to
         void make_move(Square from, Square to) {
+            hash_square(to);
+            hash_square(from);
             pieces_.move(from, to);
             if (friendlies_or_neutral_[from]) {
                 friendlies_or_neutral_ |= to;
@@ -313,6 +704,119 @@ namespace blooto {
             } else {
                 unfriendlies_or_neutral_ &= ~to;
             }
+            hash_square(to);
+        }
+
+        //! Information needed to take back a move made with do_move()
+        class Undo {
+            friend class Board;
+            std::uint64_t hash_;
+            bool capture_;
+            bool neutral_;
+            bool promotion_;
+            piececode_t captured_;
+            Undo(const Board &board, Square to, bool promotion)
+            : hash_{board.hash_}, capture_{board.occupied()[to]}
+            , neutral_{board.neutrals()[to]}, promotion_{promotion}
+            , captured_{capture_ ? board.pieces_.get(to) : piececode_t(0)} {}
+        };
+
+        //! Make a move in place and pass the turn to the opponent
+        //! @param from source square where the piece to be moved is located
+        //! @param to destination square where the piece to be moved to
+        //! @return record to pass to undo_move() to take the move back
+        Undo do_move(Square from, Square to) {
+            const Undo undo{*this, to, false};
+            const piececode_t code{pieces_.get(from)};
+            move_piece(from, to, neutrals()[from], code, code,
+                       undo.capture_, undo.captured_, undo.neutral_);
+            pieces_.move(from, to);
+            flip_colour();
+            return undo;
+        }
+
+        //! Make a move with promotion in place and pass the turn
+        //! to the opponent
+        //! @param from source square where the piece to be moved is located
+        //! @param to destination square where the piece to be moved to
+        //! @param promotion piece type to promote piece to
+        //! @return record to pass to undo_move() to take the move back
+        Undo do_move(Square from, Square to, const PieceType &promotion) {
+            const Undo undo{*this, to, true};
+            const piececode_t code{PieceTypeCodes::get(promotion)};
+            move_piece(from, to, neutrals()[from], pieces_.get(from), code,
+                       undo.capture_, undo.captured_, undo.neutral_);
+            pieces_.set(code, BitBoard{to});
+            flip_colour();
+            return undo;
+        }
+
+        //! Take back a move made with do_move()
+        //! @param from source square of the move
+        //! @param to destination square of the move
+        //! @param undo record returned by do_move()
+        //! The hash is restored from the record rather than updated.
+        void undo_move(Square from, Square to, const Undo &undo) {
+            colour_ = opposite_colour();
+            std::swap(friendlies_or_neutral_, unfriendlies_or_neutral_);
+            hash_ = undo.hash_;
+            pieces_.move(to, from);
+            if (undo.promotion_)
+                pieces_.set<PawnType>(BitBoard{from});
+            if (unfriendlies_or_neutral_[to])
+                unfriendlies_or_neutral_ |= from;
+            friendlies_or_neutral_ |= from;
+            friendlies_or_neutral_ &= ~to;
+            unfriendlies_or_neutral_ &= ~to;
+            if (undo.capture_) {
+                pieces_.set(undo.captured_, BitBoard{to});
+                unfriendlies_or_neutral_ |= to;
+                if (undo.neutral_)
+                    friendlies_or_neutral_ |= to;
+            }
+        }
+
+        //! Pack move into 16 bits
+        //! @param move move to pack
+        //! @return packed move
+        //! Type of the moving piece is dropped, so the move can only be
+        //! unpacked on the board it is made on.
+        static PackedMove pack(const Move &move) {
+            return PackedMove{
+                move.from(), move.to(), move.attack(),
+                move.promotion() ?
+                PieceTypeCodes::get(*move.promotion()) : 0u
+            };
+        }
+
+        //! Unpack move made on this board
+        //! @param move packed move
+        //! @return move with type of the piece located at its source square
+        Move unpack(PackedMove move) const {
+            const unsigned promotion{move.promotion()};
+            return Move{
+                *piecetype(move.from()), move.from(), move.to(),
+                move.attack(),
+                promotion ? PieceTypeCodes::piecetypes()[promotion] : nullptr
+            };
+        }
+
+        //! Make a packed move in place and pass the turn to the opponent
+        //! @param move move generated on this board
+        //! @return record to pass to undo_move() to take the move back
+        Undo do_move(PackedMove move) {
+            const unsigned promotion{move.promotion()};
+            if (promotion)
+                return do_move(move.from(), move.to(),
+                               *PieceTypeCodes::piecetypes()[promotion]);
+            return do_move(move.from(), move.to());
+        }
+
+        //! Take back a packed move made with do_move()
+        //! @param move the move
+        //! @param undo record returned by do_move()
+        void undo_move(PackedMove move, const Undo &undo) {
+            undo_move(move.from(), move.to(), undo);
         }
 
         //! Generate Move at this board from source and destination squares
@@ -335,9 +839,318 @@ namespace blooto {
         //! Bitboard of moves that can make a piece at given square
         //! @param square square a piece located at
         //! @return bitboard of squares this piece can move to
+        //! Piece type is dispatched at compile time rather than through
+        //! virtual PieceType::moves().
         BitBoard moves_from(Square square) const {
-            const PieceType &pt = *piecetype(square);
-            return pt.moves(colour_, square, occupied()) & ~friendlies();
+            if (white_to_move())
+                return moves_from(square, ColourWhite());
+            return moves_from(square, ColourBlack());
+        }
+
+        //! Bitboard of moves that can make a piece at given square
+        //! with move colour known at compile time
+        //! @param square square a piece located at
+        //! @param colour colour tag of the side to move
+        //! @return bitboard of squares this piece can move to
+        template <typename C>
+        BitBoard moves_from(Square square, C colour) const {
+            return
+                dispatch(pieces_.get(square),
+                         moves_op<C>{colour, square, occupied()}) &
+                ~friendlies();
+        }
+
+        //! Check whether the move is a promotion
+        //! @param from source square where the piece to be moved is located
+        //! @param to destination square where the piece to be moved to
+        //! @return true if a pawn moves to the last rank
+        bool promotes(Square from, Square to) const {
+            if (pieces_.get(from) != piece_code<PawnType>::value)
+                return false;
+            if (white_to_move())
+                return PawnType::promotion_rank(ColourWhite())[to];
+            return PawnType::promotion_rank(ColourBlack())[to];
+        }
+
+        //! Append all possible pseudo-legal moves to the list
+        //! @param list list to append moves to
+        //! Moves are appended piece type by piece type, friendly pieces
+        //! of a type before neutral ones, in the order the solver
+        //! tries them.
+        void generate(MoveList &list) const {
+            generate_moves(list, ~BitBoard{}, false);
+        }
+
+        //! Append pseudo-legal captures to the list
+        //! @param list list to append moves to
+        void generate_captures(MoveList &list) const {
+            generate_moves(list, occupied(), false);
+        }
+
+        //! Append pseudo-legal moves to empty squares to the list
+        //! @param list list to append moves to
+        void generate_quiets(MoveList &list) const {
+            generate_moves(list, ~occupied(), false);
+        }
+
+        //! Append pseudo-legal moves checking unfriendly king to the list
+        //! @param list list to append moves to
+        void generate_checks(MoveList &list) const {
+            generate_moves(list, ~BitBoard{}, true);
+        }
+
+        //! Bitboard of squares from which pieces can capture at the square
+        //! @param square square to be captured at
+        //! @param colour colour of capturing move
+        //! @param occupancy bitboard of occupied squares
+        //! @return bitboard of squares containing pieces which can capture
+        //! at the square if there were no other pieces but occupancy
+        //! Warning: may contain empty squares as well, so it must be
+        //! intersected with bitboard of capturing pieces.
+        //! Colour may be either MoveColour or colour tag known
+        //! at compile time.
+        template <typename C>
+        BitBoard attackers(Square square, C colour, BitBoard occupancy) const
+        {
+            return attackers_func<C>{*this, square, colour, occupancy}();
+        }
+
+        //! Check whether pieces that can move attack any unfriendly king,
+        //! i.e. whether the last move left its own king in check
+        //! @return true if some unfriendly king is attacked
+        bool unfriendly_king_attacked() const {
+            if (white_to_move())
+                return unfriendly_king_attacked(ColourWhite());
+            return unfriendly_king_attacked(ColourBlack());
+        }
+
+        //! Check whether pieces that can move attack any unfriendly king
+        //! with move colour known at compile time
+        //! @param colour colour tag of the side to move
+        //! @return true if some unfriendly king is attacked
+        template <typename C>
+        bool unfriendly_king_attacked(C colour) const {
+            const BitBoard occupancy{occupied()};
+            const BitBoard movers{can_move()};
+            const BitBoard queens{pieces<QueenType>()};
+            const BitBoard rooks{(pieces<RookType>() | queens) & movers};
+            const BitBoard bishops{(pieces<BishopType>() | queens) & movers};
+            const BitBoard knights{pieces<KnightType>() & movers};
+            const BitBoard kings{pieces<KingType>() & movers};
+            const BitBoard pawns{pieces<PawnType>() & movers};
+            for (Square king: pieces<KingType>() & unfriendlies()) {
+                if (!((RMagic<>::moves(king, occupancy) & rooks) |
+                      (BMagic<>::moves(king, occupancy) & bishops) |
+                      (KnightType::instance.moves(colour, king,
+                                                  occupancy) & knights) |
+                      (KingType::instance.moves(colour, king,
+                                                occupancy) & kings) |
+                      (reverse_captures(PawnType::instance, colour, king,
+                                        occupancy) & pawns)).empty())
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        //! Masks restricting pseudo-legal moves of the side to move
+        //! to legal ones, i.e. not leaving its king attacked.
+
+        //! Pinned pieces and squares evading check are computed once
+        //! on construction. The masks are exact only for single
+        //! friendly king and no neutral pieces; otherwise every move
+        //! must be checked separately.
+        class Legality {
+            const Board &board_;
+            const bool white_; // Whether unfriendly pieces are white
+            bool exact_;
+            Square king_;
+            BitBoard checkers_;
+            BitBoard evasions_;
+            BitBoard pinned_;
+            BitBoard rooks_;
+            BitBoard bishops_;
+
+            // Unfriendly sliders attacking the king with given occupancy
+            BitBoard sliders(BitBoard occupied) const {
+                return
+                    (RMagic<>::moves(king_, occupied) & rooks_) |
+                    (BMagic<>::moves(king_, occupied) & bishops_);
+            }
+
+        public:
+            //! Compute masks for the board
+            //! @param board board to compute masks for
+            explicit Legality(const Board &board)
+            : board_(board), white_{!board.white_to_move()}
+            , exact_{false}, king_{Square::A1}
+            {
+                const BitBoard kings{
+                    board.pieces<KingType>() & board.friendlies()
+                };
+                if (!board.neutrals().empty() || kings.empty() ||
+                    (kings.data() & (kings.data() - 1)) != 0)
+                {
+                    return;
+                }
+                exact_ = true;
+                king_ = *kings.begin();
+                const BitBoard occupied{board.occupied()};
+                const BitBoard unfriendlies{board.unfriendlies()};
+                checkers_ = unfriendlies & (
+                    white_ ?
+                    board.attackers(king_, ColourWhite(), occupied) :
+                    board.attackers(king_, ColourBlack(), occupied));
+                auto checker = checkers_.begin();
+                if (checker == checkers_.end())
+                    evasions_ = ~BitBoard{};
+                else if (std::next(checker) == checkers_.end())
+                    evasions_ = *checker | between(king_, *checker);
+                const BitBoard queens{board.pieces<QueenType>()};
+                rooks_ = (board.pieces<RookType>() | queens) & unfriendlies;
+                bishops_ = (board.pieces<BishopType>() | queens) & unfriendlies;
+                for (Square square:
+                     QMagic<>::moves(king_, occupied) & board.friendlies())
+                {
+                    if (!(sliders(occupied & ~square) & ~checkers_).empty())
+                        pinned_ |= square;
+                }
+            }
+
+            //! Check whether masks are exact
+            //! @return true if legal() can be used
+            bool exact() const {return exact_;}
+
+            //! Check whether friendly king is attacked
+            //! @return true if the king is in check
+            //! (meaningful only if masks are exact)
+            bool check() const {return !checkers_.empty();}
+
+            //! Restrict moves of a piece to legal ones
+            //! @param from square of the piece
+            //! @param moves pseudo-legal moves of the piece
+            //! @return legal moves of the piece
+            BitBoard legal(Square from, BitBoard moves) const {
+                const BitBoard occupied{board_.occupied()};
+                const BitBoard unfriendlies{board_.unfriendlies()};
+                if (from == king_)
+                    return moves & ~(
+                        white_ ?
+                        board_.attacks(unfriendlies, ColourWhite(),
+                                       occupied & ~king_) :
+                        board_.attacks(unfriendlies, ColourBlack(),
+                                       occupied & ~king_));
+                moves &= evasions_;
+                if (pinned_[from]) {
+                    const BitBoard pinners{
+                        sliders(occupied & ~from) & ~checkers_
+                    };
+                    const Square pinner{*pinners.begin()};
+                    moves &= pinner | between(king_, pinner);
+                }
+                return moves;
+            }
+        };
+
+        //! Bitboard of squares where piece of type PT moved from the square
+        //! gives direct check to the king
+        //! @param from square the piece is moved from
+        //! @param king square of unfriendly king
+        //! @return bitboard of squares giving direct check
+        template <typename PT>
+        BitBoard check_squares(Square from, Square king) const {
+            if (white_to_move())
+                return reverse_captures(PT::instance, ColourWhite(), king,
+                                        occupied() & ~from);
+            return reverse_captures(PT::instance, ColourBlack(), king,
+                                    occupied() & ~from);
+        }
+
+        //! Bitboard of squares where piece promoted to given piece type
+        //! gives direct check to the king
+        //! @param promotion piece type to promote to
+        //! @param from square the promoted pawn is moved from
+        //! @param king square of unfriendly king
+        //! @return bitboard of squares giving direct check
+        BitBoard check_squares(const PieceType &promotion,
+                               Square from, Square king) const
+        {
+            // All promotions move symmetrically
+            return promotion.moves(colour(), king, occupied() & ~from);
+        }
+
+        //! Bitboard of pieces which can discover check by moving
+        //! @param king square of unfriendly king
+        //! @return bitboard of pieces that can move and are the only ones
+        //! between the king and sliders that can move
+        BitBoard discoverers(Square king) const {
+            const BitBoard queens{pieces<QueenType>()};
+            const BitBoard rooks{
+                (pieces<RookType>() | queens) & can_move()
+            };
+            const BitBoard bishops{
+                (pieces<BishopType>() | queens) & can_move()
+            };
+            BitBoard result;
+            for (Square square: QMagic<>::moves(king, occupied()) &
+                                can_move())
+            {
+                const BitBoard occupancy{occupied() & ~square};
+                if (!(((RMagic<>::moves(king, occupancy) & rooks) |
+                       (BMagic<>::moves(king, occupancy) & bishops)) &
+                      ~square).empty())
+                {
+                    result |= square;
+                }
+            }
+            return result;
+        }
+
+        //! Check whether moving a piece discovers check
+        //! @param from square the piece is moved from
+        //! @param to square the piece is moved to
+        //! @param king square of unfriendly king
+        //! @return true if other pieces attack the king after the move
+        //! Only sliders can discover check, other pieces attacking
+        //! the king after the move would have attacked it before.
+        bool discovers_check(Square from, Square to, Square king) const {
+            const BitBoard occupancy{(occupied() & ~from) | to};
+            const BitBoard queens{pieces<QueenType>()};
+            const BitBoard rooks{pieces<RookType>() | queens};
+            const BitBoard bishops{pieces<BishopType>() | queens};
+            return !(((RMagic<>::moves(king, occupancy) & rooks) |
+                      (BMagic<>::moves(king, occupancy) & bishops)) &
+                     can_move() & ~to).empty();
+        }
+
+        //! Bitboard of squares attacked by pieces
+        //! @param pieces bitboard of attacking pieces
+        //! @param colour colour of attacking move
+        //! @param occupancy bitboard of occupied squares
+        //! @return bitboard of squares where the pieces can capture
+        //! if there were no other pieces but occupancy
+        //! Colour may be either MoveColour or colour tag known
+        //! at compile time.
+        template <typename C>
+        BitBoard attacks(BitBoard pieces, C colour, BitBoard occupancy) const
+        {
+            return attacks_func<C>{*this, pieces, colour, occupancy}();
+        }
+
+        //! Bitboard of squares between two squares on the same line
+        //! @param from one square
+        //! @param to another square
+        //! @return bitboard of squares strictly between them
+        //! (empty if the squares are not on the same rank, file or diagonal)
+        static BitBoard between(Square from, Square to) {
+            BitBoard rook{RMagic<>::moves(from, BitBoard{to})};
+            if (rook[to])
+                return rook & RMagic<>::moves(to, BitBoard{from});
+            BitBoard bishop{BMagic<>::moves(from, BitBoard{to})};
+            if (bishop[to])
+                return bishop & BMagic<>::moves(to, BitBoard{from});
+            return BitBoard{};
         }
 
         //! Move a piece on this board
@@ -353,7 +1166,8 @@ namespace blooto {
 
         //! Flip board colour
         void flip_colour() {
-            colour_ = colour_.opposite();
+            hash_ ^= zobrist::colour();
+            colour_ = opposite_colour();
             std::swap(friendlies_or_neutral_, unfriendlies_or_neutral_);
         }
 
@@ -491,6 +1305,7 @@ namespace blooto {
         //! Remove a piece from square
         //! @param square square to remove piece from
         void take_piece(Square square) {
+            hash_square(square);
             friendlies_or_neutral_ &= ~square;
             unfriendlies_or_neutral_ &= ~square;
         }
@@ -499,18 +1314,24 @@ namespace blooto {
         //! @param square square to put piece to
         template <typename PT>
         void put_piece(Square square, boost::mpl::false_) {
+            hash_square(square);
             pieces_.set<PT>(BitBoard{square});
             friendlies_or_neutral_ |= square;
             unfriendlies_or_neutral_ &= ~square;
+            hash_ ^= zobrist::piece(piece_code<PT>::value, colour_,
+                                    square);
         }
 
         //! Put neutral piece of type PT to square
         //! @param square square to put piece to
         template <typename PT>
         void put_piece(Square square, boost::mpl::true_) {
+            hash_square(square);
             pieces_.set<PT>(BitBoard{square});
             friendlies_or_neutral_ |= square;
             unfriendlies_or_neutral_ |= square;
+            hash_ ^= zobrist::piece(piece_code<PT>::value, zobrist::neutral,
+                                    square);
         }
 
         //! Put friendly or neutral piece of type PT to square
@@ -664,23 +1485,113 @@ namespace blooto {
         //! @param square square where the piece to be promoted is located
         //! @param p iterator pointing to promotion to be performed
         void make_promotion(Square square, promotions_iterator p) {
+            hash_square(square);
             pieces_.set(p.code(), BitBoard{square});
+            hash_square(square);
         }
 
         //! Move a promotion on this board
         //! @param square square where the piece to be promoted is located
         //! @param promotion piece type to use as promotion
         void make_promotion(Square square, const PieceType &promotion) {
+            hash_square(square);
             pieces_.set(PieceTypeCodes::get(promotion), BitBoard{square});
+            hash_square(square);
+        }
+
+        //! Make a move of friendly or neutral piece of type PT in place
+        //! and pass the turn to the opponent
+        //! @param from source square where the piece to be moved is located
+        //! @param to destination square where the piece to be moved to
+        //! @param neutral true if the piece is neutral, false otherwise
+        //! (or boost::mpl::true_ or boost::mpl::false_ to tell it
+        //! at compile time)
+        //! @return record to pass to undo_move() to take the move back
+        //! This is faster than do_move(from, to) when type of the piece
+        //! is known at compile time.
+        template <typename PT, typename Neutral>
+        Undo do_move(Square from, Square to, Neutral neutral) {
+            const Undo undo{*this, to, false};
+            constexpr piececode_t code{piece_code<PT>::value};
+            move_piece(from, to, neutral, code, code,
+                       undo.capture_, undo.captured_, undo.neutral_);
+            pieces_.set<PT>(BitBoard{to});
+            flip_colour();
+            return undo;
+        }
+
+        //! Make a move of friendly or neutral pawn with promotion in place
+        //! and pass the turn to the opponent
+        //! @param from source square where the pawn is located
+        //! @param to destination square where the pawn to be moved to
+        //! @param neutral true if the pawn is neutral, false otherwise
+        //! (or boost::mpl::true_ or boost::mpl::false_)
+        //! @param p iterator pointing to promotion to be performed
+        //! @return record to pass to undo_move() to take the move back
+        template <typename PT, typename Neutral>
+        Undo do_move(Square from, Square to, Neutral neutral,
+                     promotions_iterator p)
+        {
+            const Undo undo{*this, to, true};
+            move_piece(from, to, neutral, piece_code<PT>::value, p.code(),
+                       undo.capture_, undo.captured_, undo.neutral_);
+            pieces_.set(p.code(), BitBoard{to});
+            flip_colour();
+            return undo;
         }
 
         //! Iterator over all possible (semi-legal) moves on the board
+
+        //! Moves of all pawns are generated at once when the iterator
+        //! is constructed; moves of other pieces are generated square
+        //! by square.
         class moves_iterator {
+
+            // Moves of all pawns of the side to move
+            using PawnMoves = boost::variant<PawnType::Moves<ColourWhite>,
+                                             PawnType::Moves<ColourBlack>>;
+
+            // Visitor extracting moves of single pawn
+            class pawn_moves_from: public boost::static_visitor<BitBoard> {
+                Square square_;
+            public:
+                explicit pawn_moves_from(Square square): square_{square} {}
+                template <typename C>
+                BitBoard operator()(const PawnType::Moves<C> &moves) const {
+                    return moves.from(square_);
+                }
+            };
+
             const Board &board_;
+            PawnMoves pawn_moves_;
             BitBoard::iterator from_iter_;
             BitBoard::iterator to_iter_;
             promotions_iterator promo_iter_;
 
+            template <typename C>
+            static PawnType::Moves<C> pawn_moves(const Board &board,
+                                                 C colour)
+            {
+                return PawnType::Moves<C>{
+                    colour,
+                    board.can_move() & board.pieces<PawnType>(),
+                    board.occupied(), ~board.friendlies()
+                };
+            }
+
+            static PawnMoves pawn_moves(const Board &board) {
+                if (board.white_to_move())
+                    return pawn_moves(board, ColourWhite());
+                return pawn_moves(board, ColourBlack());
+            }
+
+            BitBoard moves_from(Square square) const {
+                if (board_.pieces_.get(square) == piece_code<PawnType>::value)
+                    return boost::apply_visitor(pawn_moves_from{square},
+                                                pawn_moves_);
+                return board_.moves_from(square);
+            }
+
         public:
 
             //! Iterator tag type
@@ -707,16 +1618,14 @@ namespace blooto {
             //! Construct move_iterator pointing to the first move
             //! @param board board ths iterator iterates over
             moves_iterator(const Board &board, begin)
-            : board_{board}, from_iter_{board.can_move().begin()}
+            : board_{board}, pawn_moves_{pawn_moves(board)}
+            , from_iter_{board.can_move().begin()}
             {
                 while (from_iter_ != board.can_move().end()) {
-                    BitBoard moves = board.moves_from(*from_iter_);
+                    BitBoard moves = moves_from(*from_iter_);
                     if (!moves.empty()) {
                         to_iter_ = moves.begin();
-                        piececode_t pcidx = board_.pieces_.get(*from_iter_);
-                        const PieceType &pt =
-                            *PieceTypeCodes::piecetypes()[pcidx];
-                        if (pt.can_be_promoted(board_.colour(), *to_iter_))
+                        if (board_.promotes(*from_iter_, *to_iter_))
                             promo_iter_ = promotions_begin();
                         else
                             promo_iter_ = promotions_iterator{};
@@ -729,7 +1638,12 @@ namespace blooto {
             //! Construct move_iterator pointing after the last move
             //! @param board board ths iterator iterates over
             moves_iterator(const Board &board, end)
-            : board_{board}, from_iter_{board.can_move().end()} {}
+            : board_{board}
+            , pawn_moves_{
+                PawnType::Moves<ColourWhite>{ColourWhite(), BitBoard{},
+                                             BitBoard{}}
+            }
+            , from_iter_{board.can_move().end()} {}
 
             //! Move this iterator points to
             //! @return move
@@ -755,12 +1669,9 @@ namespace blooto {
                     ++from_iter_;
                     if (from_iter_ == board_.can_move().end())
                         return *this;
-                    to_iter_ = board_.moves_from(*from_iter_).begin();
+                    to_iter_ = moves_from(*from_iter_).begin();
                 }
-                piececode_t pcidx = board_.pieces_.get(*from_iter_);
-                const PieceType &pt =
-                    *PieceTypeCodes::piecetypes()[pcidx];
-                if (pt.can_be_promoted(board_.colour(), *to_iter_))
+                if (board_.promotes(*from_iter_, *to_iter_))
                     promo_iter_ = promotions_begin();
                 else
                     promo_iter_ = promotions_iterator{};
@@ -781,7 +1692,7 @@ namespace blooto {
             //! Compare iterator with another one
             //! @param rhs another iterator
             //! @return true is iterators are equal
-            bool operator==(moves_iterator rhs) const {
+            bool operator==(const moves_iterator &rhs) const {
                 return
                     &board_ == &rhs.board_ &&
                     from_iter_ == rhs.from_iter_ &&
@@ -792,7 +1703,7 @@ namespace blooto {
             //! Compare iterator with another one
             //! @param rhs another iterator
             //! @return true is iterators are not equal
-            bool operator!=(moves_iterator rhs) const {
+            bool operator!=(const moves_iterator &rhs) const {
                 return
                     &board_ != &rhs.board_ ||
                     from_iter_ != rhs.from_iter_ ||
@@ -278,6 +278,19 @@ namespace blooto {
         return boost::apply_visitor(visitor(out), mc);
     }
 
+    //! Opposite move colour known at compile time.
+    //! @return black colour tag
+    constexpr ColourBlack opposite(ColourWhite) {return ColourBlack();}
+
+    //! Opposite move colour known at compile time.
+    //! @return white colour tag
+    constexpr ColourWhite opposite(ColourBlack) {return ColourWhite();}
+
+    //! Opposite move colour known at run time.
+    //! @param colour move colour
+    //! @return colour opposite to given one
+    inline MoveColour opposite(MoveColour colour) {return colour.opposite();}
+
 }
 
 #endif
@@ -42,6 +42,17 @@ namespace blooto {
             return moves_for_square[blooto::code(square)];
         }
 
+        //! All possible moves from given square for move colour known
+        //! at compile time and occupancy.
+        //! @param colour move colour tag
+        //! @param square square to originate moves from
+        //! @param occupancy BitBoard containing occipoed squares
+        //! @return BitBoard containing squares this piece can move to
+        template <typename C>
+        BitBoard moves(C colour, Square square, BitBoard occupancy) const {
+            return moves_for_square[blooto::code(square)];
+        }
+
     };
 
 }
@@ -0,0 +1,336 @@
+// This file is part of Blooto.
+//
+// Blooto is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Blooto is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _BLOOTO_MATEPICTURE_HPP
+#define _BLOOTO_MATEPICTURE_HPP
+
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+
+#include <blooto/square.hpp>
+#include <blooto/bitboard.hpp>
+#include <blooto/colour.hpp>
+#include <blooto/pawntype.hpp>
+#include <blooto/bishoptype.hpp>
+#include <blooto/rooktype.hpp>
+#include <blooto/knighttype.hpp>
+#include <blooto/queentype.hpp>
+#include <blooto/kingtype.hpp>
+
+namespace blooto {
+
+    //! Squares pieces may attack or get to with given number of moves.
+
+    //! Mate picture is the final position of a mate. In every one
+    //! of them the mated king is attacked, and each square around it
+    //! is either attacked by the mating side or occupied by a piece
+    //! of the mated side. The tables tell which squares a piece
+    //! of the mating side (white) may attack, and which squares
+    //! a piece of the mated side (black) may get to, with at most
+    //! given number of its moves. Moves are counted on empty board,
+    //! so other pieces may only make the way longer, and the squares
+    //! include all the squares for any position. Pawns may be promoted
+    //! on the way.
+    class MatePicture {
+    public:
+        //! Maximal number of moves in the tables
+        //! (with more moves, all squares are included)
+        static constexpr unsigned max_moves = 15;
+
+    private:
+        enum Kind: unsigned {
+            Pawn, Bishop, Rook, Knight, Queen, King, num_kinds
+        };
+
+        static constexpr unsigned num_squares = 64;
+        static constexpr unsigned unreachable = 0xff;
+
+        // Numbers of moves between every two squares
+        using Distances = std::vector<std::uint8_t>;
+
+        using Within = BitBoard[num_kinds][num_squares][max_moves + 1];
+
+        static Kind kind(const PawnType &) {return Pawn;}
+        static Kind kind(const BishopType &) {return Bishop;}
+        static Kind kind(const RookType &) {return Rook;}
+        static Kind kind(const KnightType &) {return Knight;}
+        static Kind kind(const QueenType &) {return Queen;}
+        static Kind kind(const KingType &) {return King;}
+
+        static Square square_of(unsigned code) {return Square(code);}
+
+        static unsigned index(unsigned from, unsigned to) {
+            return from * num_squares + to;
+        }
+
+        // Squares a piece moves to (and attacks) from the square
+        template <typename PT> static BitBoard moves(unsigned from) {
+            return PT::instance.moves(ColourWhite(), square_of(from),
+                                      BitBoard{});
+        }
+
+        // Numbers of moves of a piece from one square to another one
+        template <typename PT> static Distances moves_between() {
+            Distances dist(num_squares * num_squares, unreachable);
+            for (unsigned from = 0; from < num_squares; ++from) {
+                dist[index(from, from)] = 0;
+                BitBoard reached{square_of(from)};
+                BitBoard last{reached};
+                for (unsigned n = 1; !last.empty(); ++n) {
+                    BitBoard next;
+                    for (Square sq: last)
+                        next |= moves<PT>(code(sq));
+                    last = next & ~reached;
+                    reached |= last;
+                    for (Square sq: last)
+                        dist[index(from, code(sq))] = n;
+                }
+            }
+            return dist;
+        }
+
+        // Number of moves of a pawn from one square to another one
+        // without promotion, capturing on the way if it changes file;
+        // ranks are counted from the pawn's own side
+        static unsigned pawn_moves(unsigned from_rank, unsigned from_file,
+                                   unsigned to_rank, unsigned to_file)
+        {
+            if (from_rank == to_rank && from_file == to_file)
+                return 0;
+            const int ranks{int(to_rank) - int(from_rank)};
+            const int files{std::abs(int(to_file) - int(from_file))};
+            if (from_rank == 0 || ranks <= 0 || files > ranks)
+                return unreachable;
+            if (from_rank == 1 && ranks >= 2 && files <= ranks - 2)
+                return ranks - 1; // Double step
+            return ranks;
+        }
+
+        // Numbers of moves of a pawn going towards rank 8 (white)
+        // or rank 1 (black) without promotion
+        static Distances pawn_moves_between(bool white) {
+            Distances dist(num_squares * num_squares, unreachable);
+            for (unsigned from = 0; from < num_squares; ++from)
+                for (unsigned to = 0; to < num_squares; ++to) {
+                    const Square f{square_of(from)}, t{square_of(to)};
+                    dist[index(from, to)] = white ?
+                        pawn_moves(rank(f), file(f), rank(t), file(t)) :
+                        pawn_moves(7 - rank(f), file(f),
+                                   7 - rank(t), file(t));
+                }
+            return dist;
+        }
+
+        // Numbers of moves to attack every square, given numbers
+        // of moves to get to every square and squares from which
+        // every square is attacked
+        static Distances attack(const Distances &dist,
+                                const std::vector<BitBoard> &attackers)
+        {
+            Distances result(num_squares * num_squares, unreachable);
+            for (unsigned from = 0; from < num_squares; ++from)
+                for (unsigned to = 0; to < num_squares; ++to) {
+                    unsigned n = unreachable;
+                    for (Square sq: attackers[to])
+                        n = std::min<unsigned>(
+                            n, dist[index(from, code(sq))]
+                        );
+                    result[index(from, to)] = n;
+                }
+            return result;
+        }
+
+        // Pieces attack squares from squares they move to
+        template <typename PT> static Distances attack(const Distances &dist)
+        {
+            std::vector<BitBoard> attackers(num_squares);
+            for (unsigned to = 0; to < num_squares; ++to)
+                attackers[to] = moves<PT>(to);
+            return attack(dist, attackers);
+        }
+
+        // Make pawn distances as short as promotion on the last rank
+        // followed by distances of promoted pieces allows
+        static void promote(Distances &result, const Distances &pawn,
+                            unsigned last_rank,
+                            const std::vector<const Distances *> &pieces)
+        {
+            for (unsigned from = 0; from < num_squares; ++from)
+                for (unsigned f = 0; f < 8; ++f) {
+                    const unsigned p{code(square(f, last_rank))};
+                    const unsigned m{pawn[index(from, p)]};
+                    if (m == unreachable)
+                        continue;
+                    for (unsigned to = 0; to < num_squares; ++to)
+                        for (const Distances *piece: pieces)
+                            result[index(from, to)] = std::min<unsigned>(
+                                result[index(from, to)],
+                                m + (*piece)[index(p, to)]
+                            );
+                }
+        }
+
+        // Fill squares within every number of moves
+        static void within(BitBoard (&result)[num_squares][max_moves + 1],
+                           const Distances &dist)
+        {
+            for (unsigned from = 0; from < num_squares; ++from)
+                for (unsigned n = 0; n <= max_moves; ++n) {
+                    BitBoard squares;
+                    for (unsigned to = 0; to < num_squares; ++to)
+                        if (dist[index(from, to)] <= n)
+                            squares |= square_of(to);
+                    result[from][n] = squares;
+                }
+        }
+
+        MatePicture() {
+            const Distances bishop{moves_between<BishopType>()};
+            const Distances rook{moves_between<RookType>()};
+            const Distances knight{moves_between<KnightType>()};
+            const Distances queen{moves_between<QueenType>()};
+            const Distances king{moves_between<KingType>()};
+            const Distances bishop_attack{attack<BishopType>(bishop)};
+            const Distances rook_attack{attack<RookType>(rook)};
+            const Distances knight_attack{attack<KnightType>(knight)};
+            const Distances queen_attack{attack<QueenType>(queen)};
+            within(attack_[Bishop], bishop_attack);
+            within(attack_[Rook], rook_attack);
+            within(attack_[Knight], knight_attack);
+            within(attack_[Queen], queen_attack);
+            within(attack_[King], attack<KingType>(king));
+            // White pawns attack squares diagonally ahead of them
+            const Distances white{pawn_moves_between(true)};
+            std::vector<BitBoard> attackers(num_squares);
+            for (unsigned to = 0; to < num_squares; ++to) {
+                const Square t{square_of(to)};
+                if (rank(t) >= 1 && file(t) >= 1)
+                    attackers[to] |= square(file(t) - 1, rank(t) - 1);
+                if (rank(t) >= 1 && file(t) <= 6)
+                    attackers[to] |= square(file(t) + 1, rank(t) - 1);
+            }
+            Distances white_attack{attack(white, attackers)};
+            promote(white_attack, white, 7, {
+                &bishop_attack, &rook_attack, &knight_attack, &queen_attack
+            });
+            within(attack_[Pawn], white_attack);
+            within(reach_[Bishop], bishop);
+            within(reach_[Rook], rook);
+            within(reach_[Knight], knight);
+            within(reach_[Queen], queen);
+            within(reach_[King], king);
+            Distances black{pawn_moves_between(false)};
+            const Distances black_moves{black};
+            promote(black, black_moves, 0, {&bishop, &rook, &knight, &queen});
+            within(reach_[Pawn], black);
+            for (unsigned sq = 0; sq < num_squares; ++sq) {
+                from_[Bishop][sq] = moves<BishopType>(sq);
+                from_[Rook][sq] = moves<RookType>(sq);
+                from_[Knight][sq] = moves<KnightType>(sq);
+                from_[Queen][sq] = moves<QueenType>(sq);
+                from_[King][sq] = moves<KingType>(sq);
+            }
+        }
+
+        Within attack_;
+        Within reach_;
+        // Squares attacked from every square by pieces other than pawns
+        BitBoard from_[num_kinds][num_squares];
+
+    public:
+        MatePicture(const MatePicture &) = delete;
+        MatePicture &operator=(const MatePicture &) = delete;
+
+        //! The tables, computed when they're needed for the first time
+        //! @return reference to the tables
+        static const MatePicture &instance() {
+            static const MatePicture tables;
+            return tables;
+        }
+
+        //! Squares a white piece of type PT may attack
+        //! @param from square of the piece
+        //! @param moves number of moves of the piece
+        //! @return bitboard of squares the piece may attack
+        template <typename PT>
+        BitBoard attacks(Square from, unsigned moves) const {
+            if (moves > max_moves)
+                return ~BitBoard{};
+            return attack_[kind(PT::instance)][code(from)][moves];
+        }
+
+        //! Squares a black piece of type PT may get to
+        //! @param from square of the piece
+        //! @param moves number of moves of the piece
+        //! @return bitboard of squares the piece may get to
+        template <typename PT>
+        BitBoard reaches(Square from, unsigned moves) const {
+            if (moves > max_moves)
+                return ~BitBoard{};
+            return reach_[kind(PT::instance)][code(from)][moves];
+        }
+
+        //! Call function with squares a white piece of type PT
+        //! may attack after given number of its moves
+        //! @param from square of the piece
+        //! @param moves number of moves of the piece (at least 1)
+        //! @param func function called with bitboard of the squares
+        //! attacked from every square the piece may get to with that
+        //! many moves, but no fewer; a pawn, which may be promoted
+        //! on the way, is only counted to attack every square on its
+        //! own, so for pawns it's called once with all the squares
+        //! the pawn may attack after the moves
+        template <typename PT, typename Func>
+        void attacks_after(Square from, unsigned moves, Func func) const {
+            attacks_after(PT::instance, from, moves, func);
+        }
+
+        //! Number of moves a black piece of type PT needs
+        //! to get to the square
+        //! @param from square of the piece
+        //! @param to square to get to
+        //! @param limit maximal number of moves of interest
+        //! @return number of moves, or limit + 1 if more are needed
+        template <typename PT>
+        unsigned reach_moves(Square from, Square to, unsigned limit) const {
+            for (unsigned n = 0; n <= limit; ++n)
+                if (reaches<PT>(from, n)[to])
+                    return n;
+            return limit + 1;
+        }
+
+    private:
+        template <typename PT, typename Func>
+        void attacks_after(const PT &, Square from, unsigned moves,
+                           Func &func) const
+        {
+            const BitBoard before{reaches<PT>(from, moves - 1)};
+            for (Square sq: reaches<PT>(from, moves) & ~before)
+                func(from_[kind(PT::instance)][code(sq)]);
+        }
+
+        template <typename Func>
+        void attacks_after(const PawnType &, Square from, unsigned moves,
+                           Func &func) const
+        {
+            func(attacks<PawnType>(from, moves));
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,92 @@
+// This file is part of Blooto.
+//
+// Blooto is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Blooto is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _BLOOTO_MOVELIST_HPP
+#define _BLOOTO_MOVELIST_HPP
+
+#include <cstddef>
+#include <stdexcept>
+
+#include <blooto/packedmove.hpp>
+
+namespace blooto {
+
+    //! Fixed-capacity list of packed moves, suitable for allocation
+    //! on stack. Moves are stored in generation order;
+    //! use Board::unpack() to get full moves.
+    class MoveList {
+    public:
+        //! Maximal number of moves in the list
+        static constexpr std::size_t capacity = 256;
+
+        //! Type of list elements
+        using value_type = PackedMove;
+
+        //! Iterator over moves
+        using const_iterator = const PackedMove *;
+
+        //! Iterator over moves
+        using iterator = const_iterator;
+
+    private:
+        PackedMove moves_[capacity];
+        std::size_t size_;
+
+    public:
+        //! Construct empty list
+        MoveList(): size_{0} {}
+
+        MoveList(const MoveList &) = delete;
+        MoveList &operator=(const MoveList &) = delete;
+
+        //! Number of moves in the list
+        //! @return number of moves
+        std::size_t size() const {return size_;}
+
+        //! Check whether the list is empty
+        //! @return true if there are no moves in the list
+        bool empty() const {return size_ == 0;}
+
+        //! Remove all moves from the list
+        void clear() {size_ = 0;}
+
+        //! Append move to the list
+        //! @param move move to append
+        //! Throws std::length_error if the list is full.
+        void push_back(PackedMove move) {
+            if (size_ == capacity)
+                throw std::length_error("Too many moves");
+            moves_[size_++] = move;
+        }
+
+        //! Move by its index
+        //! @param index index of the move
+        //! @return the move
+        PackedMove operator[](std::size_t index) const {
+            return moves_[index];
+        }
+
+        //! Iterator pointing to the first move
+        //! @return iterator
+        const_iterator begin() const {return moves_;}
+
+        //! Iterator pointing after the last move
+        //! @return iterator
+        const_iterator end() const {return moves_ + size_;}
+    };
+
+}
+
+#endif
@@ -0,0 +1,105 @@
+// This file is part of Blooto.
+//
+// Blooto is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Blooto is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _BLOOTO_PACKEDMOVE_HPP
+#define _BLOOTO_PACKEDMOVE_HPP
+
+#include <cstdint>
+
+#include <blooto/square.hpp>
+
+namespace blooto {
+
+    //! Move of one piece packed into 16 bits.
+    //!
+    //! Contains source and destination squares, capture flag
+    //! and code of piece type to promote to (0 if there is no promotion).
+    //! Type of moving piece is not stored: it's recovered from the board
+    //! the move is made on (see Board::pack() and Board::unpack()).
+    class PackedMove {
+        std::uint16_t data_;
+
+        static constexpr unsigned to_shift = 6;
+        static constexpr unsigned promotion_shift = 12;
+        static constexpr unsigned attack_shift = 15;
+        static constexpr std::uint16_t square_mask = 0x3f;
+        static constexpr std::uint16_t promotion_mask = 0x7;
+
+    public:
+        //! Maximal promotion code plus one
+        static constexpr unsigned promotion_codes = promotion_mask + 1;
+
+        //! Construct uninitialized move (so that arrays are cheap)
+        PackedMove() noexcept = default;
+
+        //! Construct packed move
+        //! @param from square where the move originates from
+        //! @param to destination of the move
+        //! @param attack true if this move is attack
+        //! @param promotion code of piece type to promote to (or 0)
+        constexpr PackedMove(Square from, Square to, bool attack = false,
+                             unsigned promotion = 0) noexcept
+        : data_{static_cast<std::uint16_t>(
+                code(from) |
+                (code(to) << to_shift) |
+                ((promotion & promotion_mask) << promotion_shift) |
+                ((attack ? 1 : 0) << attack_shift))} {}
+
+        //! Square where the move originates from
+        //! @return source square
+        constexpr Square from() const {
+            return static_cast<Square>(data_ & square_mask);
+        }
+
+        //! Destination of the move
+        //! @return destination square
+        constexpr Square to() const {
+            return static_cast<Square>((data_ >> to_shift) & square_mask);
+        }
+
+        //! Whether the move is attack
+        //! @return true is the move is attack
+        constexpr bool attack() const {return (data_ >> attack_shift) != 0;}
+
+        //! Code of piece type to promote to
+        //! @return promotion code, or 0 if there is no promotion
+        constexpr unsigned promotion() const {
+            return (data_ >> promotion_shift) & promotion_mask;
+        }
+
+        //! Raw 16-bit representation
+        //! @return packed data
+        constexpr std::uint16_t data() const {return data_;}
+
+        //! Compare with other move for equality
+        //! @param rhs other move
+        //! @return true if both moves are equal
+        constexpr bool operator==(PackedMove rhs) const {
+            return data_ == rhs.data_;
+        }
+
+        //! Compare with other move for inequality
+        //! @param rhs other move
+        //! @return true if both moves are not equal
+        constexpr bool operator!=(PackedMove rhs) const {
+            return data_ != rhs.data_;
+        }
+    };
+
+    static_assert(sizeof(PackedMove) == 2, "PackedMove must fit 16 bits");
+
+}
+
+#endif
@@ -25,72 +25,37 @@
 namespace blooto {
 
     //! Class containing pawn-specific operations.
+    //!
+    //! Besides per-square interface of PieceType, moves of all pawns
+    //! of a colour can be generated at once by shifting their bitboard.
     class PawnType: public PieceTypeRegistered<PawnType> {
 
+        static constexpr BitBoard::data_type file_a = 0x0101010101010101ULL;
+        static constexpr BitBoard::data_type file_h = file_a << 7;
+
+        static constexpr BitBoard forward(ColourWhite, BitBoard bb,
+                                          unsigned offset)
+        {
+            return BitBoard{bb.data() << offset};
+        }
+
+        static constexpr BitBoard forward(ColourBlack, BitBoard bb,
+                                          unsigned offset)
+        {
+            return BitBoard{bb.data() >> offset};
+        }
+
         class moves_visitor: public boost::static_visitor<BitBoard> {
-            std::uint8_t file_;
-            std::uint8_t rank_;
+            BitBoard pawns_;
             BitBoard occupancy_;
 
         public:
 
             constexpr moves_visitor(Square square, BitBoard occupancy)
-            : file_{file(square)}, rank_{rank(square)}, occupancy_{occupancy} {}
-
-            BitBoard operator()(ColourWhite) const {
-                BitBoard result;
-                if (rank_ < 7) {
-                    if (file_ > 0) {
-                        Square sq = square(file_ - 1, rank_ + 1);
-                        if (occupancy_[sq])
-                            result |= sq;
-                    }
-                    {
-                        Square sq = square(file_, rank_ + 1);
-                        if (!occupancy_[sq])
-                            result |= sq;
-                    }
-                    if (file_ < 7) {
-                        Square sq = square(file_ + 1, rank_ + 1);
-                        if (occupancy_[sq])
-                            result |= sq;
-                    }
-                }
-                if (rank_ == 1) {
-                    Square sq1 = square(file_, rank_ + 1);
-                    Square sq2 = square(file_, rank_ + 2);
-                    if (!occupancy_[sq1] && !occupancy_[sq2])
-                        result |= sq2;
-                }
-                return result;
-            }
+            : pawns_{square}, occupancy_{occupancy} {}
 
-            BitBoard operator()(ColourBlack) const {
-                BitBoard result;
-                if (rank_ > 0) {
-                    if (file_ > 0) {
-                        Square sq = square(file_ - 1, rank_ - 1);
-                        if (occupancy_[sq])
-                            result |= sq;
-                    }
-                    {
-                        Square sq = square(file_, rank_ - 1);
-                        if (!occupancy_[sq])
-                            result |= sq;
-                    }
-                    if (file_ < 7) {
-                        Square sq = square(file_ + 1, rank_ - 1);
-                        if (occupancy_[sq])
-                            result |= sq;
-                    }
-                }
-                if (rank_ == 6) {
-                    Square sq1 = square(file_, rank_ - 1);
-                    Square sq2 = square(file_, rank_ - 2);
-                    if (!occupancy_[sq1] && !occupancy_[sq2])
-                        result |= sq2;
-                }
-                return result;
+            template <typename C> BitBoard operator()(C colour) const {
+                return PawnType::moves(colour, pawns_, occupancy_);
             }
 
         };
@@ -99,6 +64,182 @@ namespace blooto {
         //! String piece code
         constexpr static const char *codestring = "P";
 
+        //! Distance between squares of single push in square codes
+        static constexpr unsigned push_offset = 8;
+
+        //! Distance between squares of capture towards file a
+        //! @param colour move colour tag
+        //! @return offset in square codes
+        static constexpr unsigned west_offset(ColourWhite colour) {return 7;}
+
+        //! Distance between squares of capture towards file a
+        //! @param colour move colour tag
+        //! @return offset in square codes
+        static constexpr unsigned west_offset(ColourBlack colour) {return 9;}
+
+        //! Distance between squares of capture towards file h
+        //! @param colour move colour tag
+        //! @return offset in square codes
+        static constexpr unsigned east_offset(ColourWhite colour) {return 9;}
+
+        //! Distance between squares of capture towards file h
+        //! @param colour move colour tag
+        //! @return offset in square codes
+        static constexpr unsigned east_offset(ColourBlack colour) {return 7;}
+
+        //! Rank where pawns can make double push from
+        //! @param colour move colour tag
+        //! @return bitboard of the rank
+        static constexpr BitBoard initial_rank(ColourWhite colour) {
+            return BitBoard{0x000000000000ff00ULL};
+        }
+
+        //! Rank where pawns can make double push from
+        //! @param colour move colour tag
+        //! @return bitboard of the rank
+        static constexpr BitBoard initial_rank(ColourBlack colour) {
+            return BitBoard{0x00ff000000000000ULL};
+        }
+
+        //! Rank where pawns are promoted
+        //! @param colour move colour tag
+        //! @return bitboard of the rank
+        static constexpr BitBoard promotion_rank(ColourWhite colour) {
+            return BitBoard{0xff00000000000000ULL};
+        }
+
+        //! Rank where pawns are promoted
+        //! @param colour move colour tag
+        //! @return bitboard of the rank
+        static constexpr BitBoard promotion_rank(ColourBlack colour) {
+            return BitBoard{0x00000000000000ffULL};
+        }
+
+        //! Squares reached by single pushes of all pawns at once
+        //! @param colour move colour tag
+        //! @param pawns bitboard of pawns
+        //! @param occupancy BitBoard containing occupied squares
+        //! @return bitboard of destination squares
+        template <typename C>
+        static constexpr BitBoard pushes(C colour, BitBoard pawns,
+                                         BitBoard occupancy)
+        {
+            return forward(colour, pawns, push_offset) & ~occupancy;
+        }
+
+        //! Squares reached by double pushes of all pawns at once
+        //! @param colour move colour tag
+        //! @param pawns bitboard of pawns
+        //! @param occupancy BitBoard containing occupied squares
+        //! @return bitboard of destination squares
+        template <typename C>
+        static constexpr BitBoard double_pushes(C colour, BitBoard pawns,
+                                                BitBoard occupancy)
+        {
+            return pushes(colour,
+                          pushes(colour, pawns & initial_rank(colour),
+                                 occupancy),
+                          occupancy);
+        }
+
+        //! Squares reached by captures towards file a of all pawns at once
+        //! @param colour move colour tag
+        //! @param pawns bitboard of pawns
+        //! @param targets bitboard of squares that can be captured
+        //! @return bitboard of destination squares
+        template <typename C>
+        static constexpr BitBoard captures_west(C colour, BitBoard pawns,
+                                                BitBoard targets)
+        {
+            return
+                forward(colour, pawns & ~BitBoard{file_a},
+                        west_offset(colour)) & targets;
+        }
+
+        //! Squares reached by captures towards file h of all pawns at once
+        //! @param colour move colour tag
+        //! @param pawns bitboard of pawns
+        //! @param targets bitboard of squares that can be captured
+        //! @return bitboard of destination squares
+        template <typename C>
+        static constexpr BitBoard captures_east(C colour, BitBoard pawns,
+                                                BitBoard targets)
+        {
+            return
+                forward(colour, pawns & ~BitBoard{file_h},
+                        east_offset(colour)) & targets;
+        }
+
+        //! All possible moves of all pawns at once
+        //! @param colour move colour tag
+        //! @param pawns bitboard of pawns
+        //! @param occupancy BitBoard containing occupied squares
+        //! @return bitboard of destination squares
+        template <typename C>
+        static constexpr BitBoard moves(C colour, BitBoard pawns,
+                                        BitBoard occupancy)
+        {
+            return
+                pushes(colour, pawns, occupancy) |
+                double_pushes(colour, pawns, occupancy) |
+                captures_west(colour, pawns, occupancy) |
+                captures_east(colour, pawns, occupancy);
+        }
+
+        //! Moves of all pawns of a colour computed at once.
+        //! Moves of single pawns are extracted from the bitboards
+        //! of all destinations, so pawns are still visited in square order.
+        template <typename C> class Moves {
+            const C colour_;
+            const BitBoard pushes_;
+            const BitBoard double_pushes_;
+            const BitBoard captures_west_;
+            const BitBoard captures_east_;
+
+        public:
+            //! Generate moves of all pawns
+            //! @param colour move colour tag
+            //! @param pawns bitboard of pawns
+            //! @param occupancy BitBoard containing occupied squares
+            //! @param targets bitboard of squares pawns may move to
+            Moves(C colour, BitBoard pawns, BitBoard occupancy,
+                  BitBoard targets = ~BitBoard{})
+            : colour_{colour}
+            , pushes_{pushes(colour, pawns, occupancy) & targets}
+            , double_pushes_{double_pushes(colour, pawns, occupancy) &
+                             targets}
+            , captures_west_{captures_west(colour, pawns,
+                                           occupancy & targets)}
+            , captures_east_{captures_east(colour, pawns,
+                                           occupancy & targets)} {}
+
+            //! Pawns having at least one move
+            //! @return bitboard of pawns
+            BitBoard origins() const {
+                const auto back = opposite(colour_);
+                return
+                    forward(back, pushes_, push_offset) |
+                    forward(back, double_pushes_, 2 * push_offset) |
+                    forward(back, captures_west_, west_offset(colour_)) |
+                    forward(back, captures_east_, east_offset(colour_));
+            }
+
+            //! Moves of single pawn
+            //! @param square square of the pawn
+            //! @return bitboard of destination squares
+            BitBoard from(Square square) const {
+                const BitBoard pawn{square};
+                return
+                    (forward(colour_, pawn, push_offset) & pushes_) |
+                    (forward(colour_, pawn, 2 * push_offset) &
+                     double_pushes_) |
+                    (forward(colour_, pawn, west_offset(colour_)) &
+                     captures_west_) |
+                    (forward(colour_, pawn, east_offset(colour_)) &
+                     captures_east_);
+            }
+        };
+
         //! All possible moves from given square for given colour and occupancy.
         //! @param colour move colour
         //! @param square square to originate moves from
@@ -112,6 +253,30 @@ namespace blooto {
                                         colour);
         }
 
+        //! All possible moves from given square for white and occupancy.
+        //! @param colour move colour tag
+        //! @param square square to originate moves from
+        //! @param occupancy BitBoard containing occipoed squares
+        //! @return BitBoard containing squares this piece can move to
+        BitBoard moves(ColourWhite colour,
+                       Square square,
+                       BitBoard occupancy) const
+        {
+            return moves(colour, BitBoard{square}, occupancy);
+        }
+
+        //! All possible moves from given square for black and occupancy.
+        //! @param colour move colour tag
+        //! @param square square to originate moves from
+        //! @param occupancy BitBoard containing occipoed squares
+        //! @return BitBoard containing squares this piece can move to
+        BitBoard moves(ColourBlack colour,
+                       Square square,
+                       BitBoard occupancy) const
+        {
+            return moves(colour, BitBoard{square}, occupancy);
+        }
+
         //! Check whether this piece type can be promoted on given square
         //! @param colour move colour
         //! @param square square where the piece is located
@@ -125,6 +290,22 @@ namespace blooto {
             return rank(square) == boost::apply_visitor(pr, colour);
         }
 
+        //! Check whether white pawn can be promoted on given square
+        //! @param colour move colour tag
+        //! @param square square where the piece is located
+        //! @return true if the piece can be promoted
+        bool can_be_promoted(ColourWhite colour, Square square) const {
+            return promotion_rank(colour)[square];
+        }
+
+        //! Check whether black pawn can be promoted on given square
+        //! @param colour move colour tag
+        //! @param square square where the piece is located
+        //! @return true if the piece can be promoted
+        bool can_be_promoted(ColourBlack colour, Square square) const {
+            return promotion_rank(colour)[square];
+        }
+
         //! Check whether this piece type can be a candidate to promote to
         //! @return true if other pieces can be promoted to this one
         bool can_be_promotion() const override {return false;}
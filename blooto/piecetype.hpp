@@ -106,6 +106,14 @@ namespace blooto {
             return false;
         }
 
+        //! Check whether this piece type can be promoted on given square
+        //! for move colour known at compile time
+        //! @param colour move colour tag
+        //! @param square square where the piece is located
+        //! @return true if the piece can be promoted
+        template <typename C>
+        bool can_be_promoted(C colour, Square square) const {return false;}
+
         //! Check whether this piece type can be a candidate to promote to
         //! @return true if other pieces can be promoted to this one
         virtual bool can_be_promotion() const {return true;}
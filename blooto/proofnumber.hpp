@@ -0,0 +1,139 @@
+// This file is part of Blooto.
+//
+// Blooto is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Blooto is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _BLOOTO_PROOFNUMBER_HPP
+#define _BLOOTO_PROOFNUMBER_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+namespace blooto {
+
+    //! Fixed-size cache of proof and disproof numbers keyed
+    //! by position hash.
+
+    //! Proof-number search keeps for every position the number
+    //! of positions still to be solved to prove it (proof number)
+    //! and to disprove it (disproof number). A position is proved
+    //! when its proof number is 0, and disproved when its disproof
+    //! number is 0 (the other number is infinite then).
+    //! The table is an array of buckets holding several entries,
+    //! each one mapping a pair of position hash and remaining depth
+    //! to both numbers and the amount of work spent on the position.
+    //! When a bucket is full, the entry with the least work
+    //! (the cheapest one to recompute) is replaced, so memory used
+    //! by the search is bounded by the size of the table.
+    //! Unlike TranspositionTable, this table is used by single thread.
+    //! See https://chessprogramming.wikispaces.com/Proof-Number+Search
+    //! for more details.
+    class ProofNumberTable {
+    public:
+        //! Number of positions to solve, infinite for solved position
+        using number_type = std::uint32_t;
+
+        //! Infinite proof or disproof number
+        static constexpr number_type infinity = 0x7fffffff;
+
+        //! Proof and disproof numbers of a position
+        struct Numbers {
+            number_type proof;
+            number_type disproof;
+        };
+
+    private:
+        struct Entry {
+            std::uint64_t key;
+            std::uint32_t depth;
+            std::uint32_t work;     // 0 for unused entry
+            Numbers numbers;
+        };
+
+        static constexpr std::size_t bucket_size = 4;
+
+        struct Bucket {
+            Entry entries[bucket_size];
+        };
+
+        std::unique_ptr<Bucket[]> buckets_;
+        std::size_t mask_;
+
+        Bucket &bucket(std::uint64_t key) const {
+            return buckets_[key & mask_];
+        }
+
+    public:
+        //! Default table size in bytes
+        static constexpr std::size_t default_size = std::size_t(16) << 20;
+
+        //! Construct empty table
+        //! @param size table size in bytes (rounded down to power of two
+        //! number of buckets)
+        explicit ProofNumberTable(std::size_t size = default_size) {
+            std::size_t num_buckets = 1;
+            while (num_buckets * 2 * sizeof(Bucket) <= size)
+                num_buckets *= 2;
+            mask_ = num_buckets - 1;
+            buckets_.reset(new Bucket[num_buckets]());
+        }
+
+        //! Number of entries the table can hold
+        //! @return table capacity
+        std::size_t capacity() const {return (mask_ + 1) * bucket_size;}
+
+        //! Find proof and disproof numbers of a position
+        //! @param key position hash
+        //! @param depth remaining depth
+        //! @param numbers set to the numbers stored for the position
+        //! (unchanged if the position is not in the table)
+        //! @return true if the position is in the table
+        bool probe(std::uint64_t key, unsigned depth, Numbers &numbers) const
+        {
+            for (const Entry &entry: bucket(key).entries)
+                if (entry.work > 0 && entry.key == key &&
+                    entry.depth == depth)
+                {
+                    numbers = entry.numbers;
+                    return true;
+                }
+            return false;
+        }
+
+        //! Remember proof and disproof numbers of a position
+        //! @param key position hash
+        //! @param depth remaining depth
+        //! @param numbers numbers to remember
+        //! @param work amount of work spent on the position (at least 1)
+        void store(std::uint64_t key, unsigned depth, Numbers numbers,
+                   std::uint32_t work)
+        {
+            Entry *victim = nullptr;
+            for (Entry &entry: bucket(key).entries) {
+                if (entry.work == 0 ||
+                    (entry.key == key && entry.depth == depth))
+                {
+                    victim = &entry;
+                    break;
+                }
+                if (!victim || entry.work < victim->work)
+                    victim = &entry;
+            }
+            *victim = Entry{key, depth, work > 0 ? work : 1, numbers};
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,107 @@
+// This file is part of Blooto.
+//
+// Blooto is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Blooto is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _BLOOTO_REFUTATION_HPP
+#define _BLOOTO_REFUTATION_HPP
+
+#include <cstdint>
+#include <atomic>
+#include <memory>
+
+#include <blooto/square.hpp>
+
+namespace blooto {
+
+    //! Table of moves which refuted other moves, used for move ordering.
+
+    //! For every remaining depth, the table keeps two killer moves
+    //! (the latest refutations found at that depth) and history
+    //! counters keyed by source and destination squares of a move,
+    //! growing with every refutation made by the move, more so
+    //! at greater depths.
+    //! The table may be shared by several threads without locking:
+    //! concurrent updates may be lost, which only affects move order.
+    //! See https://chessprogramming.wikispaces.com/Killer+Heuristic
+    //! and https://chessprogramming.wikispaces.com/History+Heuristic
+    //! for more details.
+    class RefutationTable {
+        static constexpr unsigned num_squares = 64;
+        static constexpr std::uint32_t max_history = std::uint32_t(1) << 30;
+
+        struct Slot {
+            std::atomic<std::uint16_t> killers[2];
+            std::atomic<std::uint32_t> history[num_squares * num_squares];
+        };
+
+        static unsigned code(Square from, Square to) {
+            return unsigned(from) * num_squares + unsigned(to);
+        }
+
+        std::unique_ptr<Slot[]> slots_;
+
+    public:
+        //! Score of the latest killer move
+        //! @return score higher than any history counter
+        static constexpr std::uint32_t killer_score() {
+            return max_history + 2;
+        }
+
+        //! Construct empty table
+        //! @param depths number of remaining depths the table is used for
+        explicit RefutationTable(unsigned depths)
+        : slots_{new Slot[depths]()} {}
+
+        //! Remember that a move refuted another move
+        //! @param depth remaining depth of position where the move is made
+        //! @param from source square of the move
+        //! @param to destination square of the move
+        void refuted(unsigned depth, Square from, Square to) {
+            Slot &slot = slots_[depth];
+            const std::uint16_t move = code(from, to);
+            if (slot.killers[0].load(std::memory_order_relaxed) != move) {
+                slot.killers[1].store(
+                    slot.killers[0].load(std::memory_order_relaxed),
+                    std::memory_order_relaxed
+                );
+                slot.killers[0].store(move, std::memory_order_relaxed);
+            }
+            std::atomic<std::uint32_t> &history = slot.history[move];
+            const std::uint32_t value =
+                history.load(std::memory_order_relaxed) + depth * depth + 1;
+            history.store(value < max_history ? value : max_history,
+                          std::memory_order_relaxed);
+        }
+
+        //! Score of a move (the higher the score,
+        //! the earlier the move should be tried)
+        //! @param depth remaining depth of position where the move is made
+        //! @param from source square of the move
+        //! @param to destination square of the move
+        //! @return killer_score() for the latest killer move,
+        //! killer_score() - 1 for the previous one, history counter otherwise
+        std::uint32_t score(unsigned depth, Square from, Square to) const {
+            const Slot &slot = slots_[depth];
+            const std::uint16_t move = code(from, to);
+            if (slot.killers[0].load(std::memory_order_relaxed) == move)
+                return killer_score();
+            if (slot.killers[1].load(std::memory_order_relaxed) == move)
+                return killer_score() - 1;
+            return slot.history[move].load(std::memory_order_relaxed);
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,280 @@
+// This file is part of Blooto.
+//
+// Blooto is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Blooto is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _BLOOTO_SCHEDULER_HPP
+#define _BLOOTO_SCHEDULER_HPP
+
+#include <cstddef>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+namespace blooto {
+
+    //! Work-stealing pool of threads executing tasks.
+
+    //! Every thread (including the one which created the scheduler)
+    //! has its own queue of tasks. Spawned tasks are pushed to the queue
+    //! of the spawning thread, which takes them back in LIFO order,
+    //! while idle threads steal tasks from other queues in FIFO order.
+    //! A thread waiting for a group of tasks executes queued tasks
+    //! instead of blocking.
+    //! See https://chessprogramming.wikispaces.com/Parallel+Search
+    //! for more details.
+    class Scheduler {
+    public:
+        //! Group of tasks which can be waited for and cancelled together
+        class TaskGroup {
+            friend class Scheduler;
+            const TaskGroup *parent_;
+            std::atomic<std::size_t> pending_;
+            std::atomic<bool> cancelled_;
+            std::mutex error_mutex_;
+            std::exception_ptr error_;
+
+            // Keep the first exception thrown by a task of the group
+            // and cancel the rest of them
+            void fail(std::exception_ptr error) {
+                {
+                    std::lock_guard<std::mutex> lock{error_mutex_};
+                    if (!error_)
+                        error_ = error;
+                }
+                cancel();
+            }
+
+        public:
+            //! Construct empty task group
+            //! @param parent group to inherit cancellation from (or nullptr)
+            explicit TaskGroup(const TaskGroup *parent = nullptr)
+            : parent_{parent}, pending_{0}, cancelled_{false} {}
+
+            TaskGroup(const TaskGroup &) = delete;
+            TaskGroup &operator=(const TaskGroup &) = delete;
+
+            //! Cancel all tasks of this group and of its descendants.
+            //! Tasks which are not started yet are skipped, running tasks
+            //! should poll cancelled() and return as soon as possible.
+            void cancel() {cancelled_.store(true, std::memory_order_relaxed);}
+
+            //! Check whether this group or any of its ancestors is cancelled
+            //! @return true if the group is cancelled
+            bool cancelled() const {
+                for (const TaskGroup *group = this; group;
+                     group = group->parent_)
+                {
+                    if (group->cancelled_.load(std::memory_order_relaxed))
+                        return true;
+                }
+                return false;
+            }
+        };
+
+    private:
+        struct Task {
+            TaskGroup *group;
+            std::function<void()> func;
+        };
+
+        struct Queue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        std::vector<std::unique_ptr<Queue>> queues_;
+        std::vector<std::thread> threads_;
+        std::atomic<std::size_t> num_tasks_;
+        std::atomic<bool> stop_;
+        std::mutex idle_mutex_;
+        std::condition_variable idle_cv_;
+
+        // Number of times a thread waiting for a group yields
+        // before it blocks until there are tasks or the group is done
+        static constexpr unsigned wait_spins = 64;
+
+        struct Current {
+            const Scheduler *scheduler;
+            unsigned index;
+        };
+
+        static Current &current_thread() {
+            static thread_local Current current{nullptr, 0};
+            return current;
+        }
+
+        bool pop(unsigned index, Task &task) {
+            {
+                Queue &queue = *queues_[index];
+                std::lock_guard<std::mutex> lock{queue.mutex};
+                if (!queue.tasks.empty()) {
+                    task = std::move(queue.tasks.back());
+                    queue.tasks.pop_back();
+                    return true;
+                }
+            }
+            for (std::size_t i = 1; i < queues_.size(); ++i) {
+                Queue &queue = *queues_[(index + i) % queues_.size()];
+                std::lock_guard<std::mutex> lock{queue.mutex};
+                if (!queue.tasks.empty()) {
+                    task = std::move(queue.tasks.front());
+                    queue.tasks.pop_front();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool run_one(unsigned index) {
+            if (num_tasks_.load(std::memory_order_acquire) == 0)
+                return false;
+            Task task;
+            if (!pop(index, task))
+                return false;
+            num_tasks_.fetch_sub(1, std::memory_order_relaxed);
+            if (!task.group->cancelled()) {
+                try {
+                    task.func();
+                } catch (...) {
+                    task.group->fail(std::current_exception());
+                }
+            }
+            if (task.group->pending_.fetch_sub(1,
+                                               std::memory_order_acq_rel) == 1)
+            {
+                // Wake up the thread which may be waiting for the group
+                std::lock_guard<std::mutex> lock{idle_mutex_};
+                idle_cv_.notify_all();
+            }
+            return true;
+        }
+
+        void work(unsigned index) {
+            current_thread() = Current{this, index};
+            while (!stop_.load(std::memory_order_acquire)) {
+                if (run_one(index))
+                    continue;
+                std::unique_lock<std::mutex> lock{idle_mutex_};
+                idle_cv_.wait(lock, [this]() {
+                    return
+                        stop_.load(std::memory_order_acquire) ||
+                        num_tasks_.load(std::memory_order_acquire) > 0;
+                });
+            }
+        }
+
+    public:
+        //! Construct scheduler and start its threads
+        //! @param threads total number of threads,
+        //! including the one constructing the scheduler
+        explicit Scheduler(unsigned threads)
+        : num_tasks_{0}, stop_{false}
+        {
+            if (threads == 0)
+                threads = 1;
+            for (unsigned i = 0; i < threads; ++i)
+                queues_.emplace_back(new Queue);
+            current_thread() = Current{this, 0};
+            for (unsigned i = 1; i < threads; ++i)
+                threads_.emplace_back(&Scheduler::work, this, i);
+        }
+
+        Scheduler(const Scheduler &) = delete;
+        Scheduler &operator=(const Scheduler &) = delete;
+
+        //! Stop and join all threads
+        //! All task groups must be waited for before destruction.
+        ~Scheduler() {
+            {
+                std::lock_guard<std::mutex> lock{idle_mutex_};
+                stop_.store(true, std::memory_order_release);
+            }
+            idle_cv_.notify_all();
+            for (auto &thread: threads_)
+                thread.join();
+            if (current_thread().scheduler == this)
+                current_thread() = Current{nullptr, 0};
+        }
+
+        //! Total number of threads
+        //! @return number of threads
+        unsigned size() const {return queues_.size();}
+
+        //! Index of the calling thread within this scheduler
+        //! @return thread index in range [0, size())
+        unsigned current() const {
+            const Current &cur = current_thread();
+            return cur.scheduler == this ? cur.index : 0;
+        }
+
+        //! Add task to the queue of the calling thread
+        //! @param group group the task belongs to
+        //! @param func function to execute
+        //! If the function throws, the group is cancelled
+        //! and the exception is rethrown by wait().
+        void spawn(TaskGroup &group, std::function<void()> func) {
+            group.pending_.fetch_add(1, std::memory_order_relaxed);
+            {
+                Queue &queue = *queues_[current()];
+                std::lock_guard<std::mutex> lock{queue.mutex};
+                queue.tasks.push_back(Task{&group, std::move(func)});
+            }
+            {
+                std::lock_guard<std::mutex> lock{idle_mutex_};
+                num_tasks_.fetch_add(1, std::memory_order_release);
+            }
+            idle_cv_.notify_one();
+        }
+
+        //! Wait until all tasks of the group are finished or skipped,
+        //! executing queued tasks meanwhile
+        //! @param group group to wait for
+        //! @throw the first exception thrown by a task of the group
+        //! Without queued tasks the thread yields for a while
+        //! and then blocks until there are some or the group is done.
+        void wait(TaskGroup &group) {
+            const unsigned index = current();
+            unsigned spins = 0;
+            while (group.pending_.load(std::memory_order_acquire) > 0) {
+                if (run_one(index)) {
+                    spins = 0;
+                } else if (spins < wait_spins) {
+                    ++spins;
+                    std::this_thread::yield();
+                } else {
+                    std::unique_lock<std::mutex> lock{idle_mutex_};
+                    idle_cv_.wait(lock, [this, &group]() {
+                        return
+                            group.pending_.load(std::memory_order_acquire)
+                                == 0 ||
+                            num_tasks_.load(std::memory_order_acquire) > 0;
+                    });
+                    spins = 0;
+                }
+            }
+            // All the tasks are finished, so the error is not changed
+            if (group.error_)
+                std::rethrow_exception(group.error_);
+        }
+    };
+
+}
+
+#endif
@@ -16,58 +16,475 @@
 #ifndef _BLOOTO_SOLUTION_HPP
 #define _BLOOTO_SOLUTION_HPP
 
-#include <list>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 
 #include <blooto/move.hpp>
+#include <blooto/packedmove.hpp>
+#include <blooto/board.hpp>
 
 namespace blooto {
 
+    //! Storage for nodes of solution trees
+    //! Nodes are allocated in chunks and linked by indices; they are
+    //! freed all at once, by release() or with the arena itself.
+    //! Several threads may allocate nodes at the same time, each using
+    //! its own cursor.
+    class SolutionArena {
+    public:
+
+        //! Index of node in the arena
+        using index_type = std::uint32_t;
+
+        //! Index meaning absence of node
+        static constexpr index_type none = ~index_type{0};
+
+        //! Node of solution tree
+        struct Node {
+            //! Move made (see Board::unpack())
+            PackedMove move;
+            //! Next solution in the same list
+            index_type sibling;
+            //! First solution of the list of next moves
+            index_type child;
+            //! First solution of the list of threats
+            index_type threat;
+        };
+
+        //! Allocator of nodes used by a single thread
+        class Cursor {
+        public:
+
+            //! Construct cursor allocating nodes from given arena
+            //! @param arena arena to allocate nodes from
+            explicit Cursor(const std::shared_ptr<SolutionArena> &arena)
+            : arena_{arena}, next_{0}, end_{0} {}
+
+            //! Arena the nodes are allocated from
+            //! @return pointer to the arena
+            const std::shared_ptr<SolutionArena> &arena() const noexcept {
+                return arena_;
+            }
+
+            //! Allocate node
+            //! @param move move to store in the node
+            //! @param child index of the first solution of next moves
+            //! @param threat index of the first threat
+            //! @return index of new node
+            index_type allocate(const Move &move, index_type child,
+                                index_type threat = none)
+            {
+                if (next_ == end_ || next_ < arena_->live_) {
+                    next_ = arena_->allocate_chunk();
+                    end_ = next_ + chunk_size;
+                }
+                new (&arena_->node(next_)) Node{Board::pack(move), none,
+                                                child, threat};
+                return next_++;
+            }
+
+        private:
+
+            std::shared_ptr<SolutionArena> arena_;
+            index_type next_;
+            index_type end_;
+
+        };
+
+        //! Construct empty arena
+        SolutionArena()
+        : chunks_{new Storage *[max_chunks]}, size_{0}, live_{0} {}
+
+        SolutionArena(const SolutionArena &) = delete;
+        SolutionArena &operator=(const SolutionArena &) = delete;
+
+        ~SolutionArena() {
+            for (index_type i = live_ >> chunk_bits; i < size_; ++i)
+                delete[] chunks_[i];
+        }
+
+        //! Free all nodes allocated so far
+        //! Indices are not reused, so the nodes allocated after this
+        //! get indices for which live() is true, unlike the freed ones.
+        //! No thread may use the arena during the call.
+        void release() {
+            for (index_type i = live_ >> chunk_bits; i < size_; ++i) {
+                delete[] chunks_[i];
+                chunks_[i] = nullptr;
+            }
+            live_ = size_ << chunk_bits;
+        }
+
+        //! Whether nodes have been allocated since the last release()
+        //! @return true if release() would free any nodes
+        //! No thread may use the arena during the call.
+        bool allocated() const noexcept {
+            return (size_ << chunk_bits) != live_;
+        }
+
+        //! Whether node has not been freed by release()
+        //! @param index index of allocated node, or none
+        //! @return true if the node can be used (always for none)
+        bool live(index_type index) const noexcept {return index >= live_;}
+
+        //! Node with given index
+        //! @param index index of allocated node
+        //! @return reference to the node
+        Node &node(index_type index) noexcept {
+            return *reinterpret_cast<Node *>(
+                &chunks_[index >> chunk_bits][index & (chunk_size - 1)]
+            );
+        }
+
+        //! Node with given index
+        //! @param index index of allocated node
+        //! @return reference to the node
+        const Node &node(index_type index) const noexcept {
+            return *reinterpret_cast<const Node *>(
+                &chunks_[index >> chunk_bits][index & (chunk_size - 1)]
+            );
+        }
+
+    private:
+
+        // Nodes are never destroyed
+        static_assert(std::is_trivially_destructible<Node>::value,
+                      "nodes must be trivially destructible");
+
+        using Storage = std::aligned_storage<sizeof(Node),
+                                             alignof(Node)>::type;
+
+        static constexpr unsigned chunk_bits = 12;
+        static constexpr index_type chunk_size = index_type{1} << chunk_bits;
+        // Every release() skips the rest of the chunks in use,
+        // so all the index space is used; the chunk holding none
+        // is never allocated
+        static constexpr index_type max_chunks = none >> chunk_bits;
+
+        // Allocate new chunk and return index of its first node
+        index_type allocate_chunk() {
+            std::lock_guard<std::mutex> lock{mutex_};
+            if (size_ == max_chunks)
+                throw std::length_error{"solution arena is full"};
+            chunks_[size_] = new Storage[chunk_size];
+            return size_++ << chunk_bits;
+        }
+
+        // Entries are written under the mutex and never change then,
+        // so nodes can be read without locking by any thread which
+        // got their indices
+        std::unique_ptr<Storage *[]> chunks_;
+        index_type size_;
+        // Index of the first node not freed by release()
+        index_type live_;
+        std::mutex mutex_;
+
+    };
+
     //! Chess composition solution tree
+    //! This is a handle of a node stored in SolutionArena; it is valid
+    //! as long as the list it has been obtained from.
     class Solution {
     public:
 
         //! List of solutions containing next moves
-        using list = std::list<Solution>;
-
-        //! Construct solution containing just one move
-        //! @param from square where the move originates from
-        //! @param to destination of the move
-        //! @param piecetype type of piece that is moving
-        //! @param attack true if this move is attack
-        Solution(const PieceType &piecetype,
-                 Square from,
-                 Square to,
-                 bool attack = false) noexcept
-        : move_{piecetype, from, to, attack} {}
-
-        //! Construct solution containing just one move
-        //! @param move move the solution will contain
-        Solution(const Move &move) noexcept: move_{move} {}
+        class list;
+
+        //! First move
+        //! @return move unpacked on the board of the list
+        Move move() const {
+            return (*board_)->unpack((*arena_)->node(index_).move);
+        }
+
+        //! List of solutions containing next moves
+        list next() const;
+
+        //! List of threats, i.e. solutions which would exist
+        //! if the opponent passed after the move
+        //! (empty unless threats are requested)
+        list threat() const;
+
+    private:
+
+        Solution(const std::shared_ptr<SolutionArena> &arena,
+                 const std::shared_ptr<const Board> &board,
+                 SolutionArena::index_type index) noexcept
+        : arena_{&arena}, board_{&board}, index_{index} {}
 
-        //! Construct solution containing a move and list of subsequent moves
+        // Board after the first move, with the opponent to move
+        // unless pass is set
+        std::shared_ptr<const Board> after(bool pass) const {
+            const Move m{move()};
+            std::shared_ptr<Board> board{std::make_shared<Board>(**board_)};
+            if (m.promotion())
+                board->do_move(m.from(), m.to(), *m.promotion());
+            else
+                board->do_move(m.from(), m.to());
+            if (pass)
+                board->flip_colour();
+            return board;
+        }
+
+        const std::shared_ptr<SolutionArena> *arena_;
+        const std::shared_ptr<const Board> *board_;
+        SolutionArena::index_type index_;
+
+    };
+
+    //! List of solutions
+    //! Lists are built from the back, and a whole list is moved into
+    //! the solution it continues without copying any nodes.
+    //! Complete lists may be shared by several solutions, so the tree
+    //! is actually a DAG storing identical continuations once.
+    //! The list keeps the arena containing its nodes alive.
+    //! Moves are stored packed, so they can only be read once the list
+    //! knows the board they are made on (see board()); lists of next
+    //! moves and threats obtained from solutions know it already.
+    class Solution::list {
+    public:
+
+        //! Iterator over solutions in the list
+        class const_iterator {
+        public:
+
+            using iterator_category = std::input_iterator_tag;
+            using value_type = Solution;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const Solution *;
+            using reference = const Solution &;
+
+            //! Current solution
+            //! @return reference to solution valid until the iterator
+            //! is changed
+            reference operator*() const noexcept {return solution_;}
+
+            //! Current solution
+            //! @return pointer to solution valid until the iterator
+            //! is changed
+            pointer operator->() const noexcept {return &solution_;}
+
+            //! Go to the next solution
+            //! @return reference to this iterator
+            const_iterator &operator++() noexcept {
+                solution_.index_ =
+                    (*solution_.arena_)->node(solution_.index_).sibling;
+                return *this;
+            }
+
+            //! Go to the next solution
+            //! @return copy of this iterator before increment
+            const_iterator operator++(int) noexcept {
+                const_iterator tmp{*this};
+                ++*this;
+                return tmp;
+            }
+
+            //! Compare with other iterator of the same list for equality
+            //! @param rhs other iterator
+            //! @return true if both iterators point to the same solution
+            bool operator==(const const_iterator &rhs) const noexcept {
+                return solution_.index_ == rhs.solution_.index_;
+            }
+
+            //! Compare with other iterator of the same list for inequality
+            //! @param rhs other iterator
+            //! @return true if iterators point to different solutions
+            bool operator!=(const const_iterator &rhs) const noexcept {
+                return solution_.index_ != rhs.solution_.index_;
+            }
+
+        private:
+
+            friend class list;
+
+            const_iterator(const std::shared_ptr<SolutionArena> &arena,
+                           const std::shared_ptr<const Board> &board,
+                           SolutionArena::index_type index) noexcept
+            : solution_{arena, board, index} {}
+
+            Solution solution_;
+
+        };
+
+        using iterator = const_iterator;
+        using value_type = Solution;
+        using size_type = std::size_t;
+
+        //! Construct empty list
+        list() noexcept
+        : first_{SolutionArena::none}, last_{SolutionArena::none} {}
+
+        //! Move constructor
+        //! @param other list to take solutions from (becomes empty)
+        list(list &&other) noexcept
+        : arena_{std::move(other.arena_)}, board_{std::move(other.board_)}
+        , first_{other.first_}, last_{other.last_}
+        {
+            other.first_ = other.last_ = SolutionArena::none;
+        }
+
+        //! Move assignment operator
+        //! @param other list to take solutions from (becomes empty)
+        //! @return reference to this object
+        list &operator=(list &&other) noexcept {
+            arena_ = std::move(other.arena_);
+            board_ = std::move(other.board_);
+            first_ = other.first_;
+            last_ = other.last_;
+            other.first_ = other.last_ = SolutionArena::none;
+            return *this;
+        }
+
+        list(const list &) = delete;
+        list &operator=(const list &) = delete;
+
+        //! Construct list sharing nodes of another one
+        //! @param arena arena containing the nodes
+        //! @param root index of the first node of the other list
+        //! (as returned by root())
+        //! @return list (must not be appended to)
+        static list shared(const std::shared_ptr<SolutionArena> &arena,
+                           SolutionArena::index_type root)
+        {
+            return list{arena, root};
+        }
+
+        //! Set board the moves of the list are made on
+        //! @param board board before the moves
+        void board(const std::shared_ptr<const Board> &board) noexcept {
+            board_ = board;
+        }
+
+        //! Index of the first node of the list
+        //! @return index of node, or SolutionArena::none if list is empty
+        SolutionArena::index_type root() const noexcept {return first_;}
+
+        //! Append solution
+        //! @param cursor cursor to allocate node with
         //! @param move move the solution will contain
-        //! @param next next moves
-        Solution(const Move &move, const list &next)
-        : move_{move}, next_{next} {}
+        //! @param next next moves (must be allocated from the same arena;
+        //! becomes empty)
+        void emplace_back(SolutionArena::Cursor &cursor,
+                          const Move &move, list &&next)
+        {
+            emplace_back(cursor, move, std::move(next), list{});
+        }
 
-        //! Construct solution containing a move and list of subsequent moves
+        //! Append solution with threats
+        //! @param cursor cursor to allocate node with
         //! @param move move the solution will contain
-        //! @param next next moves
-        Solution(const Move &move, list &&next) : move_{move}, next_{next} {}
+        //! @param next next moves (must be allocated from the same arena;
+        //! becomes empty)
+        //! @param threat threats of the move (must be allocated
+        //! from the same arena; becomes empty)
+        void emplace_back(SolutionArena::Cursor &cursor,
+                          const Move &move, list &&next, list &&threat)
+        {
+            if (!arena_)
+                arena_ = cursor.arena();
+            const SolutionArena::index_type index{
+                cursor.allocate(move, next.first_, threat.first_)
+            };
+            if (last_ == SolutionArena::none)
+                first_ = index;
+            else
+                arena_->node(last_).sibling = index;
+            last_ = index;
+            next.clear();
+            threat.clear();
+        }
 
-        //! First move
-        const Move &move() const noexcept {return move_;}
+        //! Append all solutions of another list
+        //! @param other list allocated from the same arena
+        //! and not shared with other solutions (becomes empty)
+        void splice_back(list &&other) {
+            if (other.empty())
+                return;
+            if (last_ == SolutionArena::none) {
+                arena_ = std::move(other.arena_);
+                first_ = other.first_;
+            } else {
+                arena_->node(last_).sibling = other.first_;
+            }
+            last_ = other.last_;
+            other.clear();
+        }
 
-        //! List of solutions containing next moves
-        const list &next() const noexcept {return next_;}
+        //! Whether the list is empty
+        //! @return true if there are no solutions in the list
+        bool empty() const noexcept {return first_ == SolutionArena::none;}
+
+        //! Number of solutions in the list
+        //! @return number of solutions
+        //! This takes time proportional to the number of solutions.
+        size_type size() const noexcept {
+            return std::distance(begin(), end());
+        }
+
+        //! Iterator pointing to the first solution
+        //! @return iterator
+        const_iterator begin() const noexcept {
+            return {arena_, board_, first_};
+        }
+
+        //! Iterator pointing past the last solution
+        //! @return iterator
+        const_iterator end() const noexcept {
+            return {arena_, board_, SolutionArena::none};
+        }
 
     private:
 
-        Move move_;
-        list next_;
+        friend class Solution;
+
+        void clear() noexcept {
+            arena_.reset();
+            board_.reset();
+            first_ = last_ = SolutionArena::none;
+        }
+
+        list(const std::shared_ptr<SolutionArena> &arena,
+             SolutionArena::index_type first,
+             std::shared_ptr<const Board> board = nullptr)
+        : arena_{first == SolutionArena::none ? nullptr : arena}
+        , board_{std::move(board)}
+        , first_{first}, last_{first}
+        {
+            if (last_ != SolutionArena::none)
+                while (arena_->node(last_).sibling != SolutionArena::none)
+                    last_ = arena_->node(last_).sibling;
+        }
+
+        std::shared_ptr<SolutionArena> arena_;
+        std::shared_ptr<const Board> board_;
+        SolutionArena::index_type first_;
+        SolutionArena::index_type last_;
 
     };
 
+    inline Solution::list Solution::next() const {
+        const SolutionArena::index_type child{(*arena_)->node(index_).child};
+        if (child == SolutionArena::none)
+            return list{};
+        return list{*arena_, child, after(false)};
+    }
+
+    inline Solution::list Solution::threat() const {
+        const SolutionArena::index_type threat{
+            (*arena_)->node(index_).threat
+        };
+        if (threat == SolutionArena::none)
+            return list{};
+        return list{*arena_, threat, after(true)};
+    }
+
 }
 
 #endif
@@ -17,29 +17,52 @@
 #define _BLOOTO_STIPULATION_HPP
 
 #include <list>
+#include <algorithm>
+#include <iterator>
 #include <cstdint>
 #include <utility>
 #include <memory>
 #include <functional>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <stdexcept>
+#include <type_traits>
 #include <boost/optional.hpp>
 #include <boost/variant.hpp>
 
 #include <blooto/colour.hpp>
 #include <blooto/board.hpp>
+#include <blooto/movelist.hpp>
 #include <blooto/solution.hpp>
+#include <blooto/refutation.hpp>
+#include <blooto/proofnumber.hpp>
+#include <blooto/matepicture.hpp>
+#include <blooto/transposition.hpp>
+#include <blooto/scheduler.hpp>
 
 namespace blooto {
 
     //! Chess composition stipulation and solver
     class Stipulation {
 
-        enum class Failed: std::uint8_t {NotFound, IllegalMove};
+        enum class Failed: std::uint8_t {NotFound, IllegalMove, Cancelled};
 
+        // Requirement of a step, judging results of the moves one by one.
+        // Whether a single result makes the requirement fail doesn't
+        // depend on the results before it, only satisfied() and the final
+        // check of the board count them; so a fresh requirement judges
+        // a result taken on its own.
         struct Requirement: boost::static_visitor<boost::optional<Failed>> {
             using Result = boost::variant<Solution::list, Failed>;
             virtual result_type operator()(const Solution::list &) = 0;
             virtual result_type operator()(Failed) = 0;
             virtual result_type operator()(const Board &) = 0;
+            // Whether the results so far are enough to fulfil requirement
+            virtual bool satisfied() const {return false;}
+            // Whether single result may make requirement fail,
+            // so moves refuting other moves should be tried first
+            static constexpr bool refutable = false;
             virtual ~Requirement() {}
         };
 
@@ -49,7 +72,9 @@ namespace blooto {
                 switch (fail) {
                 case Failed::NotFound: return {};
                 case Failed::IllegalMove: return {};
+                case Failed::Cancelled: return {Failed::Cancelled};
                 }
+                return {fail};
             }
             result_type operator()(const Solution::list &) override {
                 ++num_results;
@@ -60,6 +85,7 @@ namespace blooto {
                     return {};
                 return {Failed::NotFound};
             }
+            bool satisfied() const override {return num_results > 0;}
         };
 
         struct RequireAllOrMate: Requirement {
@@ -68,7 +94,9 @@ namespace blooto {
                 switch (fail) {
                 case Failed::NotFound: return {Failed::NotFound};
                 case Failed::IllegalMove: return {};
+                case Failed::Cancelled: return {Failed::Cancelled};
                 }
+                return {fail};
             }
             result_type operator()(const Solution::list &) override {
                 ++num_results;
@@ -83,29 +111,7 @@ namespace blooto {
                 }
                 return {};
             }
-        };
-
-        struct RequireMate: Requirement {
-            unsigned num_illegal = 0;
-            result_type operator()(Failed fail) override {
-                switch (fail) {
-                case Failed::NotFound: return {Failed::NotFound};
-                case Failed::IllegalMove: ++num_illegal; return {};
-                }
-            }
-            result_type operator()(const Solution::list &) override {
-                return {Failed::NotFound};
-            }
-            result_type operator()(const Board &board) override {
-                if (num_illegal > 0) {
-                    Board newboard{board};
-                    newboard.flip_colour();
-                    if (!threat_to_king(newboard)) // Stalemate
-                        return {Failed::NotFound};
-                    return {};
-                }
-                return {Failed::NotFound};
-            }
+            static constexpr bool refutable = true;
         };
 
         class Solver;
@@ -113,34 +119,104 @@ namespace blooto {
         using SolverList = std::list<Solver>;
         using SolverListIterator = SolverList::const_iterator;
 
+        // State shared by all threads solving the problem in parallel
+        struct Parallel {
+            Scheduler scheduler;
+            unsigned split_depth;
+            // Allocators of solution nodes indexed by the thread,
+            // shared by all the tasks the thread executes
+            std::vector<SolutionArena::Cursor> cursors;
+            // Number of tasks spawned
+            std::atomic<unsigned long> tasks;
+            Parallel(unsigned threads, unsigned split,
+                     const std::shared_ptr<SolutionArena> &arena)
+            : scheduler{threads}, split_depth{split}
+            , cursors(scheduler.size(), SolutionArena::Cursor{arena})
+            , tasks{0} {}
+            // Allocator of solution nodes of the calling thread
+            SolutionArena::Cursor &cursor() {
+                return cursors[scheduler.current()];
+            }
+        };
+
+        struct Context {
+            TranspositionTable &table;
+            Parallel *parallel;
+            const Scheduler::TaskGroup *group;
+            // Minimal depth of positions with complete solution trees;
+            // below it, solving stops as soon as requirement is satisfied
+            unsigned tree_depth;
+            // Allocator of solution nodes used by the current thread
+            SolutionArena::Cursor &cursor;
+            RefutationTable &refutations;
+            // Whether threats of key moves are to be found
+            bool threats;
+            // Proof and disproof numbers of proof-number search
+            // (null if the search is not used)
+            ProofNumberTable *proofs;
+            // Maximal depth of positions solved by depth-first search
+            // instead of proof-number search
+            unsigned proof_leaf_depth;
+            // Whether positions where mate can't be reached in time
+            // are to be skipped
+            bool intelligent;
+            bool cancelled() const {return group && group->cancelled();}
+        };
+
         class Solver {
             using result_type = Requirement::Result;
-            using func_type = result_type(const Board &, SolverListIterator);
+            using func_type = result_type(Board &, SolverListIterator,
+                                          Context &);
             const func_type *funcp_;
+            unsigned depth_;
+            bool checks_;
         public:
-            Solver(func_type *funcp): funcp_{funcp} {}
-            result_type operator()(const Board &board,
-                                   SolverListIterator solvp) const
+            Solver(func_type *funcp, bool checks = false)
+            : funcp_{funcp}, depth_{0}, checks_{checks} {}
+            Solver(const Solver &other, unsigned depth)
+            : funcp_{other.funcp_}, depth_{depth}, checks_{other.checks_} {}
+            unsigned depth() const {return depth_;}
+            // Whether only checking moves are to be tried
+            bool checks() const {return checks_;}
+            result_type operator()(Board &board,
+                                   SolverListIterator solvp,
+                                   Context &ctx) const
             {
-                return (*funcp_)(board, solvp);
+                return (*funcp_)(board, solvp, ctx);
             }
         };
 
-        template <typename ReqT> class SolverFuncBase {
-            const Board &board_;
+        template <typename Visitor> class SolverFuncBase {
+            Board &board_;
             const BitBoard friendlies_;
             const BitBoard neutrals_;
             const BitBoard occupied_;
+            const BitBoard unfriendly_kings_;
+            const bool checks_;
+            const BitBoard discoverers_;
+            const Board::Legality legality_;
         public:
-            constexpr SolverFuncBase(const Board &board)
+            SolverFuncBase(Board &board, bool checks = false)
             : board_{board}
             , friendlies_{board.friendlies()}
             , neutrals_{board.neutrals()}
-            , occupied_{board.occupied()} {}
-            constexpr const Board &board() const {return board_;}
+            , occupied_{board.occupied()}
+            , unfriendly_kings_{board.pieces<KingType>() &
+                                board.unfriendlies()}
+            // Checks can only be found for single king
+            , checks_{checks && !unfriendly_kings_.empty() &&
+                      (unfriendly_kings_.data() &
+                       (unfriendly_kings_.data() - 1)) == 0}
+            , discoverers_{checks_ ? board.discoverers(king()) : BitBoard{}}
+            , legality_{board} {}
+            Board &board() const {return board_;}
             constexpr const BitBoard friendlies() const {return friendlies_;}
             constexpr const BitBoard neutrals() const {return neutrals_;}
             constexpr const BitBoard occupied() const {return occupied_;}
+            constexpr bool checks() const {return checks_;}
+            const Board::Legality &legality() const {return legality_;}
+            Square king() const {return *unfriendly_kings_.begin();}
+            BitBoard discoverers() const {return discoverers_;}
 
             constexpr BitBoard pieces_can_move(boost::mpl::false_) const {
                 return friendlies();
@@ -150,15 +226,17 @@ namespace blooto {
                 return neutrals();
             }
 
-            Requirement::result_type operator()(SolverListIterator solvp,
-                                                ReqT &req,
-                                                Solution::list &result) const
-            {
-                return {};
-            }
+            template <typename C>
+            bool generate(Visitor &, C) const {return false;}
         };
 
-        template <typename ReqT, typename Base, typename PT>
+        // Generate all positions reachable from the board with one legal
+        // move (or only with checking move, if requested)
+        // and pass each of them to the visitor with the move itself.
+        // Visitor returns true to stop generation.
+        // Every move is made on a copy of the board, which the visitor
+        // may change as long as it restores the position before returning.
+        template <typename Visitor, typename Base, typename PT>
         class SolverFuncUnit: public Base {
 
         public:
@@ -168,189 +246,1464 @@ namespace blooto {
             using Base::neutrals;
             using Base::occupied;
             using Base::pieces_can_move;
+            using Base::checks;
+            using Base::king;
+            using Base::discoverers;
+            using Base::legality;
 
         private:
-            template <typename Neutral>
-            Requirement::result_type call1(SolverListIterator solvp,
-                                           ReqT &req,
-                                           Solution::list &result,
-                                           Neutral neutral) const
-            {
-                BitBoard pieces_bb{
-                    pieces_can_move(neutral) & board().template pieces<PT>()
+            // Moves of pieces of type PT generated one piece at a time
+            template <typename C> class PieceMoves {
+                const C colour_;
+                const BitBoard pieces_;
+                const BitBoard occupancy_;
+                const BitBoard targets_;
+            public:
+                PieceMoves(C colour, BitBoard pieces, BitBoard occupancy,
+                           BitBoard targets)
+                : colour_{colour}, pieces_{pieces}, occupancy_{occupancy}
+                , targets_{targets} {}
+                BitBoard origins() const {return pieces_;}
+                BitBoard from(Square square) const {
+                    return
+                        PT::instance.moves(colour_, square, occupancy_) &
+                        targets_;
+                }
+            };
+
+            // Pawn moves are generated for all pawns at once
+            template <typename C>
+            using Moves =
+                typename std::conditional<std::is_same<PT, PawnType>::value,
+                                          PawnType::Moves<C>,
+                                          PieceMoves<C>>::type;
+
+            template <typename C, typename Neutral>
+            bool call1(Visitor &visit, C colour, Neutral neutral) const {
+                const Moves<C> moves{
+                    colour,
+                    pieces_can_move(neutral) & board().template pieces<PT>(),
+                    occupied(), ~friendlies()
                 };
-                for (Square from: pieces_bb) {
-                    BitBoard moves_from{
-                        PT::instance.moves(board().colour(), from,
-                                           occupied()) &
-                                           ~friendlies()
-                    };
+                for (Square from: moves.origins()) {
+                    BitBoard moves_from{moves.from(from)};
+                    const bool exact{legality().exact()};
+                    if (exact)
+                        moves_from = legality().legal(from, moves_from);
+                    BitBoard direct_checks{moves_from};
+                    bool may_discover{false};
+                    if (checks()) {
+                        direct_checks &=
+                            board().template check_squares<PT>(from, king());
+                        may_discover = discoverers()[from];
+                    }
                     for (Square to: moves_from) {
-                        Board newboard{board()};
-                        MoveColour colour{newboard.colour()};
-                        newboard.take_piece(from);
-                        newboard.put_piece<PT>(to, neutral);
-                        newboard.flip_colour();
-                        if (PT::instance.can_be_promoted(colour, to)) {
+                        const bool promotion{
+                            PT::instance.can_be_promoted(colour, to)
+                        };
+                        const bool discovered{
+                            may_discover &&
+                            board().discovers_check(from, to, king())
+                        };
+                        if (!promotion && !direct_checks[to] && !discovered)
+                            continue;
+                        if (promotion) {
                             for (auto p = Board::promotions().begin();
                                  p != Board::promotions().end(); ++p)
                             {
-                                newboard.make_promotion(to, p);
-                                Requirement::Result res{
-                                    (*solvp)(newboard, solvp)
-                                };
-                                Requirement::result_type r{
-                                    boost::apply_visitor(req, res)
-                                };
-                                if (r)
-                                    return r;
-                                if (auto slp = boost::get<Solution::list>(&res))
-                                    result.emplace_back(
-                                        Move{
-                                            PT::instance,
-                                            from, to,
-                                            occupied()[to],
-                                            &*p
-                                        },
-                                        std::move(*slp)
-                                    );
+                                if (checks() && !discovered &&
+                                    !board().check_squares(*p, from,
+                                                           king())[to])
+                                {
+                                    continue;
+                                }
+                                Board newboard{board()};
+                                newboard.template do_move<PT>(from, to,
+                                                              neutral, p);
+                                if (!exact && threat_to_king(newboard))
+                                    continue;
+                                if (visit(newboard,
+                                          Move{
+                                              PT::instance,
+                                              from, to,
+                                              occupied()[to],
+                                              &*p
+                                          }))
+                                {
+                                    return true;
+                                }
                             }
                         } else {
-                            Requirement::Result res{
-                                (*solvp)(newboard, solvp)
-                            };
-                            Requirement::result_type r{
-                                boost::apply_visitor(req, res)
-                            };
-                            if (r)
-                                return *r;
-                            if (auto slp = boost::get<Solution::list>(&res))
-                                result.emplace_back(
-                                    Move{
-                                        PT::instance,
-                                        from, to,
-                                        occupied()[to]
-                                    },
-                                    std::move(*slp)
-                                );
+                            Board newboard{board()};
+                            newboard.template do_move<PT>(from, to, neutral);
+                            if (!exact && threat_to_king(newboard))
+                                continue;
+                            if (visit(newboard,
+                                      Move{
+                                          PT::instance,
+                                          from, to,
+                                          occupied()[to]
+                                      }))
+                            {
+                                return true;
+                            }
                         }
                     }
                 }
-                return {};
+                return false;
+            }
+
+        public:
+            template <typename C>
+            bool generate(Visitor &visit, C colour) const {
+                return
+                    call1(visit, colour, boost::mpl::false_()) ||
+                    call1(visit, colour, boost::mpl::true_()) ||
+                    Base::generate(visit, colour);
             }
+        };
+
+        template <typename Visitor>
+        using SolverFuncFold =
+            typename boost::mpl::fold<Board::piecetypes_t,
+                                      SolverFuncBase<Visitor>,
+                                      SolverFuncUnit<Visitor,
+                                                     boost::mpl::_1,
+                                                     boost::mpl::_2>>::type;
 
+        // Move generation is instantiated for each side to move,
+        // so that pawn directions and promotion ranks are known
+        // at compile time.
+        template <typename Visitor>
+        struct SolverFunc: SolverFuncFold<Visitor> {
+            using Fold = SolverFuncFold<Visitor>;
+            using Fold::Fold;
+            bool operator()(Visitor &visit) const {
+                if (Fold::board().white_to_move())
+                    return Fold::generate(visit, ColourWhite());
+                return Fold::generate(visit, ColourBlack());
+            }
+        };
+
+        // Visitor solving every position passed to it
+        // and collecting solutions according to requirement
+        // (or just checking that requirement is satisfied
+        // if solution tree is not needed)
+        template <typename ReqT> class SolverVisitor {
+            SolverListIterator solvp_;
+            Context &ctx_;
+            ReqT &req_;
+            Solution::list &result_;
+            const bool tree_;
+            Requirement::result_type r_;
         public:
-            Requirement::result_type operator()(SolverListIterator solvp,
-                                                ReqT &req,
-                                                Solution::list &result) const
+            SolverVisitor(SolverListIterator solvp, Context &ctx,
+                          ReqT &req, Solution::list &result, bool tree)
+            : solvp_{solvp}, ctx_{ctx}, req_{req}, result_{result}
+            , tree_{tree} {}
+            const Requirement::result_type &result() const {return r_;}
+            bool tree() const {return tree_;}
+            bool operator()(Board &board, const Move &move) {
+                if (ctx_.cancelled()) {
+                    cancel();
+                    return true;
+                }
+                Requirement::Result res{(*solvp_)(board, solvp_, ctx_)};
+                return add(move, res);
+            }
+            void cancel() {r_ = Failed::Cancelled;}
+            bool add(const Move &move, Requirement::Result &res) {
+                r_ = boost::apply_visitor(req_, res);
+                if (r_)
+                    return true;
+                if (!tree_)
+                    return req_.satisfied();
+                if (auto slp = boost::get<Solution::list>(&res))
+                    result_.emplace_back(ctx_.cursor, move, std::move(*slp));
+                return false;
+            }
+        };
+
+        // Collect legal moves from the board (or only checking moves,
+        // if requested) in the order SolverFunc generates them
+        static void legal_moves(Board &board, bool checks, MoveList &moves)
+        {
+            const BitBoard kings{board.pieces<KingType>() &
+                                 board.unfriendlies()};
+            MoveList generated;
+            // Checks can only be found for single king
+            if (checks && !kings.empty() &&
+                (kings.data() & (kings.data() - 1)) == 0)
             {
-                if (Requirement::result_type r =
-                    call1(solvp, req, result, boost::mpl::false_()))
-                {
-                    return r;
+                board.generate_checks(generated);
+            } else {
+                board.generate(generated);
+            }
+            const Board::Legality legality{board};
+            for (PackedMove move: generated) {
+                if (legality.exact()) {
+                    if (legality.legal(move.from(), BitBoard{move.to()})[
+                            move.to()
+                        ])
+                    {
+                        moves.push_back(move);
+                    }
+                    continue;
                 }
-                if (Requirement::result_type r =
-                    call1(solvp, req, result, boost::mpl::true_()))
+                const Board::Undo undo{board.do_move(move)};
+                if (!threat_to_king(board))
+                    moves.push_back(move);
+                board.undo_move(move, undo);
+            }
+        }
+
+        // Visitor collecting moves to positions which have solutions
+        // along with their solutions
+        class KeyVisitor {
+            SolverListIterator solvp_;
+            Context &ctx_;
+            Solution::list &keys_;
+        public:
+            KeyVisitor(SolverListIterator solvp, Context &ctx,
+                       Solution::list &keys)
+            : solvp_{solvp}, ctx_{ctx}, keys_(keys) {}
+            bool operator()(Board &board, const Move &move) {
+                Requirement::Result res{(*solvp_)(board, solvp_, ctx_)};
+                if (auto slp = boost::get<Solution::list>(&res))
+                    keys_.emplace_back(ctx_.cursor, move, std::move(*slp));
+                return false;
+            }
+        };
+
+        // Solve position after a move as if the opponent passed;
+        // the solutions are threats of the move. There are no threats
+        // if the move gives check, so the opponent may not pass.
+        // Step pointed to by solvp is the one of the opponent's move.
+        static Solution::list threats(const Board &board,
+                                      SolverListIterator solvp,
+                                      Context &ctx)
+        {
+            Solution::list keys;
+            Board newboard{board};
+            newboard.flip_colour();
+            if (threat_to_king(newboard))
+                return keys;
+            const bool checks{(++solvp)->checks()};
+            ++solvp;
+            KeyVisitor visit{solvp, ctx, keys};
+            SolverFunc<KeyVisitor>{newboard, checks}(visit);
+            return keys;
+        }
+
+        static inline bool threat_to_king(const Board &board) {
+            return board.unfriendly_king_attacked();
+        }
+
+        // Visitor looking for any (legal) move
+        struct LegalMoveVisitor {
+            bool found = false;
+            bool operator()(const Board &, const Move &) {
+                found = true;
+                return true;
+            }
+        };
+
+        // Check whether the side to move is checkmated
+        // by trying every move
+        static bool is_checkmate_generic(Board &board) {
+            LegalMoveVisitor visit;
+            SolverFunc<LegalMoveVisitor>{board}(visit);
+            if (visit.found)
+                return false;
+            Board newboard{board};
+            newboard.flip_colour();
+            return threat_to_king(newboard); // Otherwise stalemate
+        }
+
+        // Check whether the side to move is checkmated.
+        // Instead of trying every move, check king moves to squares
+        // not attacked by opponent and (for single check) moves
+        // capturing checking piece or interposing between it and king.
+        // Neutral pieces and several (or no) kings are handled
+        // by the generic method.
+        static bool is_checkmate(Board &board) {
+            if (board.white_to_move())
+                return is_checkmate(board, ColourBlack());
+            return is_checkmate(board, ColourWhite());
+        }
+
+        // The same with colour of unfriendly pieces known at compile time
+        template <typename C>
+        static bool is_checkmate(Board &board, C colour) {
+            const BitBoard kings{board.pieces<KingType>() &
+                                 board.friendlies()};
+            const BitBoard::data_type kings_data{kings.data()};
+            if (!board.neutrals().empty() ||
+                kings_data == 0 || (kings_data & (kings_data - 1)) != 0)
+            {
+                return is_checkmate_generic(board);
+            }
+            const Square king{*kings.begin()};
+            const BitBoard occupied{board.occupied()};
+            const BitBoard unfriendlies{board.unfriendlies()};
+            const BitBoard checkers{
+                board.attackers(king, colour, occupied) & unfriendlies
+            };
+            if (checkers.empty())
+                return false;
+            const BitBoard occupied_but_king{occupied & ~king};
+            for (Square to: board.moves_from(king))
+                if ((board.attackers(to, colour, occupied_but_king) &
+                     unfriendlies).empty())
                 {
-                    return r;
+                    return false;
+                }
+            auto checker_iter = checkers.begin();
+            const Square checker{*checker_iter};
+            if (++checker_iter != checkers.end()) // Double check
+                return true;
+            const BitBoard targets{checker | Board::between(king, checker)};
+            for (Square from: board.friendlies() & ~king) {
+                for (Square to: board.moves_from(from) & targets) {
+                    const BitBoard newoccupied{(occupied & ~from) | to};
+                    if ((board.attackers(king, colour, newoccupied) &
+                         unfriendlies & ~to).empty())
+                    {
+                        return false;
+                    }
                 }
-                return Base::operator()(solvp, req, result);
             }
-        };
+            return true;
+        }
 
+        static Requirement::Result solver_mate(Board &board,
+                                               SolverListIterator,
+                                               Context &)
+        {
+            if (is_checkmate(board))
+                return Solution::list{};
+            return Failed::NotFound;
+        }
+
+        // Solve positions reachable from the board with one move
+        // as parallel tasks and pass results to the visitor in the order
+        // of move generation, so the solutions are the same as for
+        // single-threaded solving. All tasks share the transposition
+        // table. As soon as some task gets a result making the requirement
+        // fail (or satisfied, if solution tree is not needed), the
+        // remaining tasks are cancelled; results of skipped and cancelled
+        // tasks are not needed then, because every such failure is
+        // Failed::NotFound. Otherwise the whole subtree has been cancelled
+        // from above.
         template <typename ReqT>
-        using SolverFunc =
-            typename boost::mpl::fold<Board::piecetypes_t,
-                                      SolverFuncBase<ReqT>,
-                                      SolverFuncUnit<ReqT,
-                                                     boost::mpl::_1,
-                                                     boost::mpl::_2>>::type;
+        static void split(Board &board,
+                          bool checks,
+                          SolverListIterator solvp,
+                          Context &ctx,
+                          SolverVisitor<ReqT> &visit)
+        {
+            MoveList moves;
+            legal_moves(board, checks, moves);
+            std::vector<boost::optional<Requirement::Result>>
+                results(moves.size());
+            Parallel &parallel = *ctx.parallel;
+            parallel.tasks.fetch_add(moves.size(), std::memory_order_relaxed);
+            Scheduler::TaskGroup group{ctx.group};
+            for (std::size_t i = 0; i < moves.size(); ++i)
+                parallel.scheduler.spawn(group, [&, i]() {
+                    Context wctx{ctx.table, &parallel, &group,
+                                 ctx.tree_depth,
+                                 parallel.cursor(),
+                                 ctx.refutations, ctx.threats, ctx.proofs,
+                                 ctx.proof_leaf_depth, ctx.intelligent};
+                    // Every task makes its move on its own board
+                    Board child{board};
+                    child.do_move(moves[i]);
+                    Requirement::Result res{(*solvp)(child, solvp, wctx)};
+                    auto fail = boost::get<Failed>(&res);
+                    if (fail && *fail == Failed::Cancelled)
+                        return;
+                    // Stop the other tasks once this result alone fails
+                    // the requirement, or fulfils it without solution tree
+                    ReqT req;
+                    if (boost::apply_visitor(req, res) ||
+                        (!visit.tree() && req.satisfied()))
+                    {
+                        group.cancel();
+                    }
+                    results[i] = std::move(res);
+                });
+            parallel.scheduler.wait(group);
+            bool skipped = false;
+            for (std::size_t i = 0; i < moves.size(); ++i) {
+                if (!results[i])
+                    skipped = true;
+                else if (visit.add(board.unpack(moves[i]), *results[i]))
+                    return;
+            }
+            if (skipped)
+                visit.cancel();
+        }
 
-        class ThreatFuncBase {
-            const Board &board_;
-            const BitBoard unfriendly_kings_;
+        // Visitor looking for the first move to position which has solution
+        class ThreatVisitor {
+            SolverListIterator solvp_;
+            Context &ctx_;
+            boost::optional<Move> move_;
         public:
-            ThreatFuncBase(const Board &board)
-            : board_{board}
-            , unfriendly_kings_{board.pieces<KingType>() & board.unfriendlies()}
-            {}
-            const Board &board() const {return board_;}
-            const BitBoard unfriendly_kings() const {return unfriendly_kings_;}
-            bool operator()() const {return false;}
+            ThreatVisitor(SolverListIterator solvp, Context &ctx)
+            : solvp_{solvp}, ctx_{ctx} {}
+            const boost::optional<Move> &move() const {return move_;}
+            bool operator()(Board &board, const Move &move) {
+                Requirement::Result res{(*solvp_)(board, solvp_, ctx_)};
+                if (!boost::get<Solution::list>(&res))
+                    return false;
+                move_.emplace(move);
+                return true;
+            }
         };
 
-        template <typename Base, typename PT> struct ThreatFuncUnit: Base {
-            using Base::Base;
-            using Base::board;
-            using Base::unfriendly_kings;
-            bool operator()() const {
-                BitBoard pieces_bb{
-                    board().can_move() & board().template pieces<PT>()
+        // Find the first threat of position with defender to move,
+        // that is the first move solving it if the defender passed.
+        // Step pointed to by solvp is the one of the attacker's move.
+        static boost::optional<Move> threat_move(const Board &board,
+                                                 SolverListIterator solvp,
+                                                 Context &ctx)
+        {
+            Board newboard{board};
+            newboard.flip_colour();
+            if (threat_to_king(newboard))
+                return {};
+            ThreatVisitor visit{std::next(solvp), ctx};
+            SolverFunc<ThreatVisitor>{newboard, solvp->checks()}(visit);
+            return visit.move();
+        }
+
+        // Check whether the threat solves position after a defense.
+        // Only defenses which don't touch the squares the threat moves
+        // from, to and through are tried, as the threat is still
+        // a possible move after them.
+        // Step pointed to by solvp is the one of the attacker's move.
+        static bool threat_holds(Board &board, const Move &defense,
+                                 const Move &threat,
+                                 SolverListIterator solvp, Context &ctx)
+        {
+            const BitBoard squares{
+                threat.from() | threat.to() |
+                Board::between(threat.from(), threat.to())
+            };
+            if (squares[defense.from()] || squares[defense.to()])
+                return false;
+            const Board::Undo undo{
+                threat.promotion() ?
+                board.do_move(threat.from(), threat.to(),
+                              *threat.promotion()) :
+                board.do_move(threat.from(), threat.to())
+            };
+            bool holds{false};
+            if (!threat_to_king(board)) {
+                const SolverListIterator next{std::next(solvp)};
+                Requirement::Result res{(*next)(board, next, ctx)};
+                holds = boost::get<Solution::list>(&res) != nullptr;
+            }
+            board.undo_move(threat.from(), threat.to(), undo);
+            return holds;
+        }
+
+        // Solve positions reachable from the board with one move,
+        // trying first the moves which refuted other moves at the same
+        // depth, and pass results to the visitor in the order of move
+        // generation, so the solutions are the same as without
+        // reordering. Only the first refutation found is passed
+        // to the visitor, which fails the requirement then.
+        // Without solution tree, defenses which don't touch the squares
+        // and lines of the threat are answered by the threat if it still
+        // works, and only the other ones are solved in full.
+        template <typename ReqT>
+        static void refute(Board &board,
+                           bool checks,
+                           unsigned depth,
+                           SolverListIterator solvp,
+                           Context &ctx,
+                           SolverVisitor<ReqT> &visit)
+        {
+            MoveList moves;
+            legal_moves(board, checks, moves);
+            std::vector<std::pair<std::uint32_t, std::size_t>> order;
+            order.reserve(moves.size());
+            for (std::size_t i = 0; i < moves.size(); ++i)
+                order.emplace_back(
+                    ctx.refutations.score(depth, moves[i].from(),
+                                          moves[i].to()),
+                    i
+                );
+            std::stable_sort(order.begin(), order.end(),
+                             [](const std::pair<std::uint32_t, std::size_t> &a,
+                                const std::pair<std::uint32_t, std::size_t> &b)
+                             {return a.first > b.first;});
+            std::vector<boost::optional<Requirement::Result>>
+                results(moves.size());
+            // Solve the position after the i-th move unless the threat
+            // answers it; return true to stop once it refutes the move
+            auto refuted = [&](std::size_t i,
+                               const boost::optional<Move> &threat) {
+                if (ctx.cancelled()) {
+                    visit.cancel();
+                    return true;
+                }
+                const Move move{board.unpack(moves[i])};
+                const Board::Undo undo{board.do_move(moves[i])};
+                const bool answered{
+                    threat && threat_holds(board, move, *threat, solvp, ctx)
                 };
-                for (Square from: pieces_bb) {
-                    BitBoard moves_from{
-                        PT::instance.moves(board().colour(), from,
-                                           board().occupied())
-                    };
-                    if (!(moves_from & unfriendly_kings()).empty())
-                        return true;
+                Requirement::Result res{Solution::list{}};
+                if (!answered)
+                    res = (*solvp)(board, solvp, ctx);
+                board.undo_move(moves[i], undo);
+                // Whether this defense alone refutes the move
+                ReqT req;
+                if (!answered && boost::apply_visitor(req, res)) {
+                    auto fail = boost::get<Failed>(&res);
+                    if (fail && *fail == Failed::NotFound)
+                        ctx.refutations.refuted(depth, move.from(),
+                                                move.to());
+                    visit.add(move, res);
+                    return true;
                 }
-                return Base::operator()();
+                results[i] = std::move(res);
+                return false;
+            };
+            // Threat is looked for only once the defenses which refuted
+            // something have been tried, as they may well make it needless
+            auto o = order.begin();
+            for (; o != order.end() && (visit.tree() || o->first > 0); ++o)
+                if (refuted(o->second, boost::none))
+                    return;
+            if (o != order.end()) {
+                const boost::optional<Move> threat{
+                    threat_move(board, solvp, ctx)
+                };
+                for (; o != order.end(); ++o)
+                    if (refuted(o->second, threat))
+                        return;
+            }
+            for (std::size_t i = 0; i < moves.size(); ++i)
+                if (visit.add(board.unpack(moves[i]), *results[i]))
+                    return;
+        }
+
+        // Add squares pieces of type PT among white may attack
+        // in given number of moves
+        template <typename PT>
+        static void attacked_squares(const Board &board, BitBoard white,
+                                     unsigned moves, BitBoard &attacked)
+        {
+            const MatePicture &picture = MatePicture::instance();
+            for (Square from: board.pieces<PT>() & white)
+                attacked |= picture.attacks<PT>(from, moves);
+        }
+
+        // Add squares pieces of type PT among black may get to
+        // in given number of moves
+        template <typename PT>
+        static void reached_squares(const Board &board, BitBoard black,
+                                    unsigned moves, BitBoard &reached)
+        {
+            const MatePicture &picture = MatePicture::instance();
+            for (Square from: board.pieces<PT>() & black)
+                reached |= picture.reaches<PT>(from, moves);
+        }
+
+        // Minimal depth of positions checked for mate pictures one
+        // by one; with the mating move left, generating the checks
+        // is as fast
+        static constexpr unsigned picture_depth = 2;
+
+        // Squares of mate picture white pieces may attack: every piece
+        // gets a range of options, the first one holding the squares
+        // it attacks where it stands, and the others the squares
+        // it may attack after some of its moves, unless it may attack
+        // them all with fewer moves
+        struct PictureOptions {
+            struct Option {
+                BitBoard squares;
+                unsigned moves;
+            };
+            static constexpr unsigned capacity = 256;
+            static constexpr unsigned max_pieces = 16;
+            Option options[capacity];
+            unsigned count = 0;
+            // Starts of the ranges of the pieces, and the end
+            unsigned ranges[max_pieces + 1];
+            unsigned pieces = 0;
+            // Squares attacked by the pieces which can't do better
+            // than stay where they are
+            BitBoard standing;
+            bool full = false;
+
+            void add(unsigned first, BitBoard squares, unsigned moves) {
+                for (unsigned i = first; i < count; ++i)
+                    if ((squares & ~options[i].squares).empty())
+                        return;
+                if (count == capacity) {
+                    full = true;
+                    return;
+                }
+                options[count++] = {squares, moves};
             }
         };
 
-        using ThreatFunc =
-            typename boost::mpl::fold<Board::piecetypes_t,
-                                      ThreatFuncBase,
-                                      ThreatFuncUnit<boost::mpl::_1,
-                                                     boost::mpl::_2>>::type;
+        // Add options of white pieces of type PT to attack the squares
+        // with at most limit moves
+        template <typename PT>
+        static void picture_options(const Board &board, BitBoard white,
+                                    BitBoard squares, unsigned limit,
+                                    PictureOptions &options)
+        {
+            const MatePicture &picture = MatePicture::instance();
+            for (Square from: board.pieces<PT>() & white) {
+                if (options.count == options.capacity ||
+                    options.pieces == options.max_pieces)
+                {
+                    options.full = true;
+                    return;
+                }
+                const unsigned first{options.count};
+                const BitBoard standing{
+                    picture.attacks<PT>(from, 0) & squares
+                };
+                options.options[options.count++] = {standing, 0};
+                for (unsigned n = 1; n <= limit; ++n)
+                    picture.attacks_after<PT>(from, n, [&](BitBoard sqs) {
+                        options.add(first, sqs & squares, n);
+                    });
+                if (options.count == first + 1) {
+                    options.standing |= standing;
+                    options.count = first;
+                } else {
+                    options.ranges[options.pieces++] = first;
+                }
+            }
+            options.ranges[options.pieces] = options.count;
+        }
 
-        static inline bool threat_to_king(const Board &board) {
-            return ThreatFunc(board)();
+        // Mate picture with the black king on given square and the moves
+        // of black pieces other than the king to block each flight
+        struct PictureSquares {
+            Square king;
+            BitBoard squares;
+            std::uint8_t block[64];
+            unsigned black_limit;
+            unsigned blockers_count;
+
+            // Whether black may block the squares not attacked
+            // by white in time
+            bool blocked(BitBoard attacked) const {
+                if (!attacked[king])
+                    return false;
+                unsigned moves = 0, count = 0;
+                for (Square sq: squares & ~attacked) {
+                    moves += block[code(sq)];
+                    ++count;
+                }
+                return moves <= black_limit && count <= blockers_count;
+            }
+        };
+
+        // Check whether white pieces from the given one on may attack
+        // the squares of the picture which black can't block, with
+        // at most moves moves, given squares already attacked
+        // and the squares the pieces may attack at best (reachable)
+        static bool cover_picture(const PictureOptions &options,
+                                  const PictureSquares &picture,
+                                  const BitBoard *reachable,
+                                  unsigned piece, unsigned moves,
+                                  BitBoard attacked)
+        {
+            if (piece == options.pieces)
+                return picture.blocked(attacked);
+            if (!picture.blocked(attacked | reachable[piece]))
+                return false;
+            for (unsigned i = options.ranges[piece];
+                 i < options.ranges[piece + 1]; ++i)
+            {
+                const auto &option = options.options[i];
+                if (option.moves <= moves &&
+                    cover_picture(options, picture, reachable, piece + 1,
+                                  moves - option.moves,
+                                  attacked | option.squares))
+                    return true;
+            }
+            return false;
         }
 
-        static Requirement::Result solver_end(const Board &board,
-                                              SolverListIterator solvp)
+        // Check whether mate picture with the black king on the square
+        // may be reached. White must attack the king, and every flight
+        // of the king is either attacked by white or blocked by another
+        // black piece. Pictures are enumerated as the squares every
+        // white piece attacks, from where it stands or from a single
+        // square it gets to, and the flights left to black; each side
+        // moves one piece per move, so the moves of its pieces add up,
+        // and must fit in white_moves, or in black_moves along with
+        // king_moves of the king. The flights are blocked by the nearest
+        // black pieces, reached holding the squares they get to with
+        // every number of moves up to black_moves.
+        // Moves are counted on empty board, as in mate_feasible().
+        static bool picture_feasible(const Board &board, Square king,
+                                     BitBoard white,
+                                     const BitBoard *reached,
+                                     unsigned blockers_count,
+                                     unsigned king_moves,
+                                     unsigned white_moves,
+                                     unsigned black_moves)
         {
-            Solution::list result;
-            if (threat_to_king(board))
-                return Failed::IllegalMove;
-            return Solution::list{};
+            PictureSquares picture;
+            picture.king = king;
+            picture.black_limit = black_moves - king_moves;
+            picture.blockers_count = blockers_count;
+            picture.squares = BitBoard{king} |
+                KingType::instance.moves(ColourWhite(), king, BitBoard{});
+            for (Square sq: picture.squares) {
+                unsigned n = 0;
+                while (n <= picture.black_limit && !reached[n][sq])
+                    ++n;
+                picture.block[code(sq)] = n;
+            }
+            picture.block[code(king)] = picture.black_limit + 1;
+            PictureOptions options;
+            picture_options<QueenType>(board, white, picture.squares,
+                                       white_moves, options);
+            picture_options<RookType>(board, white, picture.squares,
+                                      white_moves, options);
+            picture_options<BishopType>(board, white, picture.squares,
+                                        white_moves, options);
+            picture_options<KnightType>(board, white, picture.squares,
+                                        white_moves, options);
+            picture_options<PawnType>(board, white, picture.squares,
+                                      white_moves, options);
+            picture_options<KingType>(board, white, picture.squares,
+                                      white_moves, options);
+            if (options.full)
+                return true;
+            BitBoard reachable[PictureOptions::max_pieces + 1];
+            reachable[options.pieces] = BitBoard{};
+            for (unsigned piece = options.pieces; piece-- > 0;) {
+                reachable[piece] = reachable[piece + 1];
+                for (unsigned i = options.ranges[piece];
+                     i < options.ranges[piece + 1]; ++i)
+                    reachable[piece] |= options.options[i].squares;
+            }
+            return cover_picture(options, picture, reachable, 0,
+                                 white_moves, options.standing);
+        }
+
+        // Check whether mate by the last move of a helpmate may be
+        // reached from the position with depth remaining steps.
+        // There must be a square the black king may get to in time
+        // which white pieces may attack in time, and every square
+        // around it must be attacked as well, or else occupied by some
+        // other black piece which may get there in time. Otherwise
+        // there are no mate pictures, so there are no mates at all.
+        // Squares passing this quick test are checked one by one
+        // with picture_feasible().
+        // White moves at odd depths, black at even ones.
+        // Neutral pieces, which may check either king, and several
+        // (or no) black kings are not handled.
+        static bool mate_feasible(const Board &board, unsigned depth) {
+            // Pieces get anywhere with more moves than in the tables
+            if (!board.neutrals().empty() ||
+                depth >= 2 * MatePicture::max_moves)
+                return true;
+            const bool white_to_move{board.white_to_move()};
+            const BitBoard white{
+                white_to_move ? board.friendlies() : board.unfriendlies()
+            };
+            const BitBoard black{
+                white_to_move ? board.unfriendlies() : board.friendlies()
+            };
+            const BitBoard black_kings{board.pieces<KingType>() & black};
+            if (black_kings.count() != 1)
+                return true;
+            const unsigned white_moves{(depth + 1) / 2};
+            BitBoard attacked;
+            attacked_squares<QueenType>(board, white, white_moves, attacked);
+            attacked_squares<RookType>(board, white, white_moves, attacked);
+            attacked_squares<BishopType>(board, white, white_moves, attacked);
+            attacked_squares<KnightType>(board, white, white_moves, attacked);
+            attacked_squares<PawnType>(board, white, white_moves, attacked);
+            attacked_squares<KingType>(board, white, white_moves, attacked);
+            const unsigned black_moves{depth / 2};
+            const BitBoard blockers{black & ~black_kings};
+            // Squares other black pieces may get to with every number
+            // of moves
+            BitBoard reached[MatePicture::max_moves + 1];
+            for (unsigned n = 0; n <= black_moves; ++n) {
+                reached_squares<QueenType>(board, blockers, n, reached[n]);
+                reached_squares<RookType>(board, blockers, n, reached[n]);
+                reached_squares<BishopType>(board, blockers, n, reached[n]);
+                reached_squares<KnightType>(board, blockers, n, reached[n]);
+                reached_squares<PawnType>(board, blockers, n, reached[n]);
+            }
+            const unsigned blockers_count{blockers.count()};
+            const MatePicture &picture = MatePicture::instance();
+            const Square black_king{*black_kings.begin()};
+            const BitBoard king_squares{
+                picture.reaches<KingType>(black_king, black_moves)
+            };
+            for (Square sq: king_squares & attacked) {
+                const BitBoard flights{
+                    KingType::instance.moves(ColourWhite(), sq, BitBoard{}) &
+                    ~attacked
+                };
+                if (!(flights & ~reached[black_moves]).empty() ||
+                    flights.count() > blockers_count)
+                    continue;
+                const unsigned king_moves{
+                    picture.reach_moves<KingType>(black_king, sq,
+                                                  black_moves)
+                };
+                if (depth < picture_depth ||
+                    picture_feasible(board, sq, white, reached,
+                                     blockers_count, king_moves,
+                                     white_moves, black_moves))
+                    return true;
+            }
+            return false;
+        }
+
+        using ProofNumbers = ProofNumberTable::Numbers;
+        using proof_number_type = ProofNumberTable::number_type;
+
+        static constexpr proof_number_type proof_infinity =
+            ProofNumberTable::infinity;
+
+        // Proof and disproof numbers from the view of the side to move,
+        // which proves the requirement of attacker's step and disproves
+        // the one of defender's step; converts the numbers both ways
+        static ProofNumbers proof_view(ProofNumbers numbers, bool attacker) {
+            if (attacker)
+                return numbers;
+            return {numbers.disproof, numbers.proof};
+        }
+
+        // Sum of proof numbers, infinite if any of them is
+        static proof_number_type proof_sum(proof_number_type a,
+                                           proof_number_type b)
+        {
+            if (a >= proof_infinity || b >= proof_infinity)
+                return proof_infinity;
+            return std::min(a + b, proof_infinity - 1);
+        }
+
+        // Proof and disproof numbers of a position with given key
+        // and remaining steps known so far
+        static ProofNumbers proof_numbers(std::uint64_t key, unsigned depth,
+                                          Context &ctx)
+        {
+            ProofNumbers numbers{1, 1};
+            ctx.proofs->probe(key, depth, numbers);
+            return numbers;
+        }
+
+        // Proof and disproof numbers of a position known so far;
+        // mate is checked at once
+        static ProofNumbers proof_numbers(Board &board,
+                                          SolverListIterator solvp,
+                                          Context &ctx)
+        {
+            const unsigned depth{solvp->depth()};
+            if (depth == 0) {
+                if (is_checkmate(board))
+                    return {0, proof_infinity};
+                return {proof_infinity, 0};
+            }
+            return proof_numbers(board.hash(), depth, ctx);
+        }
+
+        // Depth-first proof-number search (df-pn) for directmates,
+        // where attacker moves at odd depths and defender at even ones.
+        // The position is expanded, always going to the child
+        // most promising for the side to move, until its numbers
+        // (from the view of the side to move) reach the thresholds
+        // or the position is solved; the numbers are kept in the table
+        // along with the number of positions expanded, returned in work.
+        // See Nagai, "Df-pn algorithm for searching AND/OR trees
+        // and its applications" (2002).
+        static ProofNumbers prove(Board &board,
+                                  SolverListIterator solvp, Context &ctx,
+                                  proof_number_type phi_threshold,
+                                  proof_number_type delta_threshold,
+                                  std::uint32_t &work)
+        {
+            const unsigned depth{solvp->depth()};
+            const bool attacker{depth % 2 == 1};
+            const std::uint64_t key{board.hash()};
+            work = 0;
+            ProofNumbers numbers{proof_numbers(board, solvp, ctx)};
+            ProofNumbers view{proof_view(numbers, attacker)};
+            if (view.proof >= phi_threshold ||
+                view.disproof >= delta_threshold)
+            {
+                return numbers;
+            }
+            work = 1;
+            // Positions with few remaining steps are solved at once
+            // by depth-first search, which is much faster for them
+            // (solver() doesn't start proof-number search there);
+            // only existence of solution matters, so no tree is built
+            if (depth <= ctx.proof_leaf_depth) {
+                const unsigned tree_depth{ctx.tree_depth};
+                ctx.tree_depth = depth + 1;
+                Requirement::Result res{(*solvp)(board, solvp, ctx)};
+                ctx.tree_depth = tree_depth;
+                if (boost::get<Solution::list>(&res))
+                    numbers = {0, proof_infinity};
+                else
+                    numbers = {proof_infinity, 0};
+                ctx.proofs->store(key, depth, numbers, work);
+                return numbers;
+            }
+            MoveList moves;
+            legal_moves(board, solvp->checks(), moves);
+            const SolverListIterator next{std::next(solvp)};
+            // Children have steps left, so their numbers are just looked
+            // up by their keys: every move is made once here, and then
+            // only the move to the child to be expanded
+            std::vector<std::uint64_t> keys;
+            keys.reserve(moves.size());
+            for (PackedMove move: moves) {
+                const Board::Undo undo{board.do_move(move)};
+                keys.push_back(board.hash());
+                board.undo_move(move, undo);
+            }
+            for (;;) {
+                // The side to move needs just one child proved
+                // for itself, and all of them to disprove the position
+                view = {proof_infinity, 0};
+                std::size_t best = 0;
+                proof_number_type best_phi = 0;
+                proof_number_type second_delta = proof_infinity;
+                for (std::size_t i = 0; i < moves.size(); ++i) {
+                    const ProofNumbers child{
+                        proof_view(proof_numbers(keys[i], next->depth(),
+                                                 ctx),
+                                   !attacker)
+                    };
+                    if (child.disproof < view.proof) {
+                        second_delta = view.proof;
+                        view.proof = child.disproof;
+                        best = i;
+                        best_phi = child.proof;
+                    } else if (child.disproof < second_delta) {
+                        second_delta = child.disproof;
+                    }
+                    view.disproof = proof_sum(view.disproof, child.proof);
+                }
+                // Without moves, defender is either mated or stalemated
+                if (moves.empty() && !attacker) {
+                    Board newboard{board};
+                    newboard.flip_colour();
+                    if (!threat_to_king(newboard))
+                        view = {0, proof_infinity};
+                }
+                if (view.proof >= phi_threshold ||
+                    view.disproof >= delta_threshold)
+                {
+                    break;
+                }
+                const proof_number_type child_phi_threshold(
+                    std::min<std::uint64_t>(
+                        std::uint64_t(delta_threshold) + best_phi -
+                        view.disproof,
+                        proof_infinity
+                    )
+                );
+                // Threshold of the best child slightly exceeds numbers
+                // of the second best one (1 + epsilon trick by Pawlewicz
+                // and Lew), so the search doesn't switch between them
+                // too often
+                const proof_number_type child_delta_threshold{
+                    std::min(phi_threshold,
+                             second_delta + second_delta / 4 + 1)
+                };
+                std::uint32_t child_work;
+                const Board::Undo undo{board.do_move(moves[best])};
+                prove(board, next, ctx, child_phi_threshold,
+                      child_delta_threshold, child_work);
+                board.undo_move(moves[best], undo);
+                work = std::max(work, work + child_work); // Saturated
+            }
+            numbers = proof_view(view, attacker);
+            ctx.proofs->store(key, depth, numbers, work);
+            return numbers;
+        }
+
+        // Solve position with proof-number search
+        static ProofNumbers prove(Board &board,
+                                  SolverListIterator solvp, Context &ctx)
+        {
+            std::uint32_t work;
+            return prove(board, solvp, ctx, proof_infinity, proof_infinity,
+                         work);
         }
 
         template <typename ReqT>
-        static Requirement::Result solver(const Board &board,
-                                          SolverListIterator solvp)
+        static Requirement::Result solver(Board &board,
+                                          SolverListIterator solvp,
+                                          Context &ctx)
         {
+            using Outcome = TranspositionTable::Outcome;
+            const std::uint64_t key{board.hash()};
+            const unsigned depth{solvp->depth()};
+            const bool tree{depth >= ctx.tree_depth};
+            // With solution tree, the table keeps root of the tree
+            // along with the outcome, so the same continuations
+            // reached by different moves are solved and stored once
+            // (or solved again if the tree has been released since).
+            // Without solution tree, the root is none, which is always
+            // live, so such outcome doesn't count when the tree is needed
+            // (neither does the empty solution of a mated position,
+            // which is cheap to find again).
+            SolutionArena::index_type root;
+            switch (ctx.table.probe(key, depth, root)) {
+            case Outcome::NotFound: return Failed::NotFound;
+            case Outcome::Found:
+                if (!tree)
+                    return Solution::list{};
+                if (root != SolutionArena::none &&
+                    ctx.cursor.arena()->live(root))
+                {
+                    return Solution::list::shared(ctx.cursor.arena(), root);
+                }
+                break;
+            case Outcome::Unknown: break;
+            }
+
+            if (ctx.intelligent && !mate_feasible(board, depth)) {
+                ctx.table.store(key, depth, Outcome::NotFound);
+                return Failed::NotFound;
+            }
+
+            // Proof-number search decides the position, so the moves
+            // are only tried when the solution tree is needed;
+            // positions with few remaining steps are searched
+            // depth-first, as proof-number search would do anyway
+            if (ctx.proofs && depth > ctx.proof_leaf_depth) {
+                if (prove(board, solvp, ctx).proof != 0) {
+                    ctx.table.store(key, depth, Outcome::NotFound);
+                    return Failed::NotFound;
+                }
+                if (!tree) {
+                    ctx.table.store(key, depth, Outcome::Found,
+                                    SolutionArena::none);
+                    return Solution::list{};
+                }
+            }
+
+            ReqT req;
+            const bool checks{solvp->checks()};
+            ++solvp;
+            Solution::list result;
+            SolverVisitor<ReqT> visit{solvp, ctx, req, result, tree};
+            if (ctx.parallel && depth >= ctx.parallel->split_depth)
+                split(board, checks, solvp, ctx, visit);
+            else if (ReqT::refutable)
+                refute(board, checks, depth, solvp, ctx, visit);
+            else
+                SolverFunc<SolverVisitor<ReqT>>{board, checks}(visit);
+            Requirement::result_type r{visit.result()};
+            if (!r)
+                r = req(board);
+            if (r) {
+                if (*r == Failed::NotFound)
+                    ctx.table.store(key, depth, Outcome::NotFound);
+                return *r;
+            }
+            ctx.table.store(key, depth, Outcome::Found, result.root());
+            return result;
+        }
+
+        // Call function with solving context building solution trees
+        // for positions with at least tree_depth remaining steps
+        // (positions to be solved first have top_depth remaining steps
+        // and are always split between threads)
+        template <typename Func>
+        void with_context(unsigned tree_depth, unsigned top_depth,
+                          Func func) const
+        {
+            TranspositionTable table{std::size_t(hash_size_) << 20};
+            SolutionArena::Cursor cursor{std::make_shared<SolutionArena>()};
+            RefutationTable refutations{unsigned(solvlist_.size())};
+            tasks_ = 0;
+            if (proof_number_search()) {
+                // Proof-number search is single-threaded
+                ProofNumberTable proofs{std::size_t(hash_size_) << 20};
+                Context ctx{table, nullptr, nullptr, tree_depth, cursor,
+                            refutations, threats(), &proofs,
+                            proof_leaf_depth_, false};
+                func(ctx);
+            } else if (threads_ > 1) {
+                Parallel parallel{threads_,
+                                  std::min(split_depth_, top_depth),
+                                  cursor.arena()};
+                Context ctx{table, &parallel, nullptr, tree_depth,
+                            parallel.cursor(),
+                            refutations, threats(), nullptr,
+                            proof_leaf_depth_, intelligent()};
+                func(ctx);
+                tasks_ = parallel.tasks;
+            } else {
+                Context ctx{table, nullptr, nullptr, tree_depth, cursor,
+                            refutations, threats(), nullptr,
+                            proof_leaf_depth_, intelligent()};
+                func(ctx);
+            }
+        }
+
+        // Solve problem building solution trees for positions
+        // with at least tree_depth remaining steps
+        Requirement::Result run(const Board &board, unsigned tree_depth) const
+        {
+            // Only legal moves are generated, so just initial position
+            // must be checked for legality
             if (threat_to_king(board))
                 return Failed::IllegalMove;
+            Requirement::Result res{Failed::NotFound};
+            // Solvers may make and take back moves on the board they get
+            Board root{board};
+            with_context(tree_depth, solvlist_.front().depth(),
+                         [&](Context &ctx) {
+                res = solvlist_.front()(root, solvlist_.begin(), ctx);
+            });
+            return res;
+        }
 
-            ReqT req;
+        // Visitor counting positions which have solutions
+        // until the limit is reached
+        class CountVisitor {
+            SolverListIterator solvp_;
+            Context &ctx_;
+            const unsigned limit_;
+            unsigned count_;
+        public:
+            CountVisitor(SolverListIterator solvp, Context &ctx,
+                         unsigned limit)
+            : solvp_{solvp}, ctx_{ctx}, limit_{limit}, count_{0} {}
+            unsigned count() const {return count_;}
+            bool operator()(Board &board, const Move &) {
+                Requirement::Result res{(*solvp_)(board, solvp_, ctx_)};
+                if (boost::get<Solution::list>(&res))
+                    ++count_;
+                return limit_ > 0 && count_ == limit_;
+            }
+        };
+
+        // Visitor passing every solution found to a function
+        // as soon as the position after the first move is solved
+        // (with its threats if requested) as a list of one solution;
+        // with release set, the solution trees are freed after every
+        // first move, so the function must not keep the list
+        template <typename Func> class StreamVisitor {
+            SolverListIterator solvp_;
+            Context &ctx_;
+            Func &func_;
+            const bool release_;
+            unsigned count_;
+        public:
+            StreamVisitor(SolverListIterator solvp, Context &ctx, Func &func,
+                          bool release)
+            : solvp_{solvp}, ctx_{ctx}, func_(func), release_{release}
+            , count_{0} {}
+            unsigned count() const {return count_;}
+            bool operator()(Board &board, const Move &move) {
+                Requirement::Result res{(*solvp_)(board, solvp_, ctx_)};
+                if (auto slp = boost::get<Solution::list>(&res)) {
+                    Solution::list threat;
+                    // Last move before mate has no threat
+                    if (ctx_.threats && solvp_->depth() >= 2)
+                        threat = threats(board, solvp_, ctx_);
+                    Solution::list sl;
+                    sl.emplace_back(ctx_.cursor, move, std::move(*slp),
+                                    std::move(threat));
+                    func_(std::move(sl));
+                    ++count_;
+                }
+                // Tasks of the move are over, so no thread uses the arena;
+                // every release takes the rest of the chunks in use
+                // out of the index space, so moves which allocated
+                // nothing don't release
+                if (release_ && ctx_.cursor.arena()->allocated())
+                    ctx_.cursor.arena()->release();
+                return false;
+            }
+        };
+
+        // Pass solutions of the stipulation starting with given step
+        // to the function one by one, releasing solution trees
+        // after every first move if release is set
+        template <typename Func>
+        static unsigned stream_step(Board &board,
+                                    SolverListIterator solvp,
+                                    Context &ctx, Func &func, bool release)
+        {
+            // The first step of every stipulation accepts any move
+            // which has solution, so every such move is a solution
+            // on its own and may be passed on before the others.
+            const bool checks{solvp->checks()};
             ++solvp;
+            StreamVisitor<Func> visit{solvp, ctx, func, release};
+            SolverFunc<StreamVisitor<Func>>{board, checks}(visit);
+            return visit.count();
+        }
+
+        // Solve problem passing solutions to the function one by one,
+        // building solution trees for positions with at least
+        // tree_depth remaining steps and releasing them after every
+        // first move if release is set
+        template <typename Func>
+        unsigned stream(const Board &board, unsigned tree_depth,
+                        Func &func, bool release) const
+        {
+            if (threat_to_king(board))
+                return 0;
+            unsigned count = 0;
+            const unsigned depth{solvlist_.front().depth()};
+            Board root{board};
+            with_context(tree_depth, depth - 1, [&](Context &ctx) {
+                count = stream_step(root, solvlist_.begin(), ctx, func,
+                                    release);
+            });
+            return count;
+        }
+
+        // Solve problem in every number of half-moves up to the full one
+        // having the same parity, fewest first, passing solutions
+        // to the function along with the number of half-moves
+        // and stopping after the first one with solutions if shortest
+        // is set; return the fewest number of half-moves with solutions
+        // (0 if there are no solutions)
+        template <typename Func>
+        unsigned iterate(const Board &board, bool keys, bool shortest,
+                         Func &func) const
+        {
+            if (threat_to_king(board))
+                return 0;
+            // Steps of every stipulation are the same regardless of the
+            // number of moves, so the last steps form the stipulation
+            // with fewer moves: the table keeps the same outcomes for
+            // the same positions and depths, while the outcomes found
+            // by shorter iterations, along with the refutations, prune
+            // and order the search in longer ones. Solution trees are
+            // built for all the positions, or only for the initial one,
+            // so outcomes stored without them stay valid as well.
+            unsigned found = 0;
+            const unsigned full{solvlist_.front().depth()};
+            Board root{board};
+            with_context(0, full - 1, [&](Context &ctx) {
+                for (unsigned depth = 2 - full % 2; depth <= full;
+                     depth += 2)
+                {
+                    ctx.tree_depth = keys ? depth : 0;
+                    auto pass = [&](Solution::list &&sl) {
+                        func(depth, std::move(sl));
+                    };
+                    if (stream_step(root,
+                                    std::prev(solvlist_.end(), depth + 1),
+                                    ctx, pass, true) > 0 && found == 0)
+                    {
+                        found = depth;
+                        if (shortest)
+                            break;
+                    }
+                }
+            });
+            return found;
+        }
+
+        // Solve problem collecting solutions passed by stream()
+        Solution::list collect(const Board &board, unsigned tree_depth) const
+        {
             Solution::list result;
-            Requirement::result_type r{
-                SolverFunc<ReqT>(board)(solvp, req, result)
+            auto append = [&](Solution::list &&sl) {
+                result.splice_back(std::move(sl));
             };
-            if (r)
-                return *r;
-            r = req(board);
-            if (r)
-                return *r;
+            stream(board, tree_depth, append, false);
+            result.board(std::make_shared<const Board>(board));
             return result;
         }
 
         MoveColour first_move_colour_;
         SolverList solvlist_;
+        unsigned threads_;
+        unsigned split_depth_;
+        unsigned hash_size_;
+        unsigned proof_leaf_depth_;
+        bool directmate_;
+        bool threats_;
+        bool proof_number_search_;
+        bool intelligent_;
+        // Number of tasks of the last solving
+        mutable unsigned long tasks_;
 
-        Stipulation(MoveColour first_move_colour, SolverList &&solvlist)
-        : first_move_colour_ {first_move_colour}, solvlist_{solvlist} {}
+        Stipulation(MoveColour first_move_colour, SolverList &&solvlist,
+                    bool directmate = false)
+        : first_move_colour_ {first_move_colour}
+        , threads_{1}
+        , split_depth_{default_split_depth}
+        , hash_size_{default_hash_size}
+        , proof_leaf_depth_{default_proof_leaf_depth}
+        , directmate_{directmate}
+        , threats_{false}
+        , proof_number_search_{false}
+        , intelligent_{false}
+        , tasks_{0}
+        {
+            unsigned depth = solvlist.size();
+            for (const Solver &solv: solvlist)
+                solvlist_.emplace_back(solv, --depth);
+        }
 
     public:
 
+        //! Default minimal number of remaining half-moves
+        //! for splitting the search between threads
+        static constexpr unsigned default_split_depth = 4;
+
+        //! Default size of transposition table in megabytes
+        static constexpr unsigned default_hash_size = 64;
+
+        //! Default maximal depth of positions solved by depth-first
+        //! search in proof-number search
+        static constexpr unsigned default_proof_leaf_depth = 5;
+
         //! Colour of the first move
         //! @return move colour
         MoveColour first_move_colour() const {return first_move_colour_;}
 
+        //! Number of threads used for solving
+        //! @return number of threads
+        unsigned threads() const {return threads_;}
+
+        //! Set number of threads used for solving
+        //! @param threads number of threads (0 means hardware concurrency)
+        //! Moves are distributed among the threads by work stealing.
+        //! Solutions are the same as with single thread,
+        //! in the same order.
+        void threads(unsigned threads) {
+            if (threads == 0)
+                threads = std::thread::hardware_concurrency();
+            threads_ = threads > 0 ? threads : 1;
+        }
+
+        //! Minimal depth for splitting the search between threads
+        //! @return number of remaining solver steps
+        unsigned split_depth() const {return split_depth_;}
+
+        //! Set minimal depth for splitting the search between threads
+        //! @param depth number of remaining solver steps
+        //! Moves from every position with at least that many steps
+        //! remaining (and from the initial position) are solved
+        //! as separate tasks. Greater values reduce the overhead
+        //! of scheduling, smaller ones improve load balancing.
+        void split_depth(unsigned depth) {split_depth_ = depth;}
+
+        //! Number of tasks the last solving was split into
+        //! @return number of positions solved as separate tasks
+        //! (0 for single thread)
+        //! The count is kept by the stipulation, so it is only
+        //! meaningful when a single thread solves with it at a time.
+        unsigned long tasks() const {return tasks_;}
+
+        //! Size of transposition table
+        //! @return size in megabytes
+        unsigned hash_size() const {return hash_size_;}
+
+        //! Set size of transposition table
+        //! @param size size in megabytes
+        //! The table is shared by all threads.
+        void hash_size(unsigned size) {hash_size_ = size;}
+
+        //! Whether threats of key moves are found
+        //! @return true if threats are found
+        bool threats() const {
+            return directmate_ && solvlist_.size() > 2 && threats_;
+        }
+
+        //! Set whether threats of key moves are found
+        //! @param threats true if threats are to be found
+        //! Threat of a key move is what the key would achieve if the
+        //! opponent passed; only directmates of more than one move
+        //! have threats, and for other stipulations this has no effect.
+        //! Threats are available as Solution::threat() of solutions.
+        void threats(bool threats) {threats_ = threats;}
+
+        //! Whether proof-number search is used
+        //! @return true if proof-number search is used
+        bool proof_number_search() const {
+            return directmate_ && proof_number_search_;
+        }
+
+        //! Set whether proof-number search is used
+        //! @param search true if proof-number search is to be used
+        //! Proof-number search decides every position by expanding
+        //! the most promising moves first, guided by the numbers
+        //! of positions still to be solved to prove or disprove it,
+        //! which is much faster than trying every move in turn
+        //! for deep directmates. Solution trees are then built
+        //! from the proved positions, so solutions are the same.
+        //! The search is only available for directmates (for other
+        //! stipulations this has no effect), runs in single thread,
+        //! and keeps the numbers in a table of hash_size() megabytes
+        //! in addition to the transposition table.
+        void proof_number_search(bool search) {
+            proof_number_search_ = search;
+        }
+
+        //! Maximal depth of positions solved by depth-first search
+        //! in proof-number search
+        //! @return number of remaining solver steps
+        unsigned proof_leaf_depth() const {return proof_leaf_depth_;}
+
+        //! Set maximal depth of positions solved by depth-first search
+        //! in proof-number search
+        //! @param depth number of remaining solver steps (at least 1)
+        //! Proof-number search doesn't pay for positions with few
+        //! remaining steps, so it only expands the deeper ones.
+        void proof_leaf_depth(unsigned depth) {
+            proof_leaf_depth_ = depth > 0 ? depth : 1;
+        }
+
+        //! Whether positions where mate can't be reached are skipped
+        //! @return true if such positions are skipped
+        bool intelligent() const {return !directmate_ && intelligent_;}
+
+        //! Set whether positions where mate can't be reached are skipped
+        //! @param intelligent true if such positions are to be skipped
+        //! In every mate of a helpmate, the black king stands
+        //! on a square attacked by white, and each square around it
+        //! is attacked as well or occupied by another black piece.
+        //! In intelligent mode, before trying moves from a position,
+        //! the solver checks whether such a mate picture may be reached
+        //! with the remaining moves (counting moves on empty board),
+        //! and skips the position otherwise. Solutions are the same.
+        //! Mate pictures are enumerated for every square the black
+        //! king may get to: each white piece attacks some of the king
+        //! and its flights from where it stands or from a single square
+        //! it gets to, the other flights are left to other black pieces,
+        //! and the moves of the pieces of each side must add up
+        //! to no more than the moves of that side left.
+        //! This is a subset of intelligent mode of Popeye: final squares
+        //! of the pieces are not fixed and moves are not generated
+        //! towards them, the usual search only skips positions
+        //! from which no mate picture may be reached. So long helpmates
+        //! are not solved dramatically faster, and white rooks
+        //! and queens, which may attack any square within two moves,
+        //! leave little to skip.
+        //! Only helpmates have intelligent mode (for other stipulations
+        //! this has no effect), and positions with neutral pieces
+        //! are never skipped.
+        void intelligent(bool intelligent) {intelligent_ = intelligent;}
+
         //! Create stipulation for directmate
         //! @param num_moves number of moves
         //! @return stipulation
@@ -360,10 +1713,10 @@ namespace blooto {
                 solvlist.emplace_back(&solver<RequireAny>);
                 solvlist.emplace_back(&solver<RequireAllOrMate>);
             }
-            solvlist.emplace_back(&solver<RequireAny>);
-            solvlist.emplace_back(&solver<RequireMate>);
-            solvlist.emplace_back(&solver_end);
-            return {ColourWhite(), std::move(solvlist)};
+            // Only checking move can be followed by mate
+            solvlist.emplace_back(&solver<RequireAny>, true);
+            solvlist.emplace_back(&solver_mate);
+            return {ColourWhite(), std::move(solvlist), true};
         }
 
         //! Create stipulation for helpmate
@@ -373,10 +1726,10 @@ namespace blooto {
             SolverList solvlist;
             for (unsigned i = 0; i < num_moves; ++i) {
                 solvlist.emplace_back(&solver<RequireAny>);
-                solvlist.emplace_back(&solver<RequireAny>);
+                // Only checking move can be followed by mate
+                solvlist.emplace_back(&solver<RequireAny>, i + 1 == num_moves);
             }
-            solvlist.emplace_back(&solver<RequireMate>);
-            solvlist.emplace_back(&solver_end);
+            solvlist.emplace_back(&solver_mate);
             return {ColourBlack(), std::move(solvlist)};
         }
 
@@ -389,9 +1742,9 @@ namespace blooto {
                 solvlist.emplace_back(&solver<RequireAny>);
                 solvlist.emplace_back(&solver<RequireAny>);
             }
-            solvlist.emplace_back(&solver<RequireAny>);
-            solvlist.emplace_back(&solver<RequireMate>);
-            solvlist.emplace_back(&solver_end);
+            // Only checking move can be followed by mate
+            solvlist.emplace_back(&solver<RequireAny>, true);
+            solvlist.emplace_back(&solver_mate);
             return {ColourWhite(), std::move(solvlist)};
         }
 
@@ -399,12 +1752,210 @@ namespace blooto {
         //! @param board board to solve problem for
         //! @result list of solutions (empty if no solutions found)
         Solution::list solve(const Board &board) const {
-            const Solver &solv{solvlist_.front()};
-            Requirement::Result res{solv(board, solvlist_.begin())};
-            if (auto slp = boost::get<Solution::list>(&res))
+            if (threats())
+                return collect(board, 0);
+            Requirement::Result res{run(board, 0)};
+            if (auto slp = boost::get<Solution::list>(&res)) {
+                slp->board(std::make_shared<const Board>(board));
                 return std::move(*slp);
-            else
+            } else {
+                return Solution::list();
+            }
+        }
+
+        //! Find key moves of chess composition problem with given board
+        //! @param board board to solve problem for
+        //! @result list of solutions without continuations
+        //! (empty if no solutions found)
+        //! Only existence of continuations is checked, so this is
+        //! much faster than solve().
+        Solution::list solve_keys(const Board &board) const {
+            if (threats())
+                return collect(board, solvlist_.front().depth());
+            Requirement::Result res{run(board, solvlist_.front().depth())};
+            if (auto slp = boost::get<Solution::list>(&res)) {
+                slp->board(std::make_shared<const Board>(board));
+                return std::move(*slp);
+            } else {
                 return Solution::list();
+            }
+        }
+
+        //! Solve chess composition problem with given board
+        //! passing every solution as soon as it is found
+        //! @param board board to solve problem for
+        //! @param func function called with every solution
+        //! (a key move with its continuations) in the same order
+        //! as solve() returns them; the solution is only valid
+        //! during the call
+        //! @result number of solutions
+        //! Solution trees are freed after every key move, so memory
+        //! is bounded by the tree of one key move rather than all
+        //! of them; continuations shared with earlier key moves are
+        //! solved again.
+        template <typename Func>
+        unsigned solve(const Board &board, Func func) const {
+            const std::shared_ptr<const Board> root{
+                std::make_shared<const Board>(board)
+            };
+            auto pass = [&](Solution::list &&sl) {
+                sl.board(root);
+                func(*sl.begin());
+            };
+            return stream(board, 0, pass, true);
+        }
+
+        //! Find key moves of chess composition problem with given board
+        //! passing every key move as soon as it is found
+        //! @param board board to solve problem for
+        //! @param func function called with every solution
+        //! without continuations in the same order as solve_keys()
+        //! returns them; the solution is only valid during the call
+        //! @result number of solutions
+        template <typename Func>
+        unsigned solve_keys(const Board &board, Func func) const {
+            const std::shared_ptr<const Board> root{
+                std::make_shared<const Board>(board)
+            };
+            auto pass = [&](Solution::list &&sl) {
+                sl.board(root);
+                func(*sl.begin());
+            };
+            return stream(board, solvlist_.front().depth(), pass, true);
+        }
+
+        //! Solve chess composition problem with given board
+        //! in fewer moves first, passing every solution as soon
+        //! as it is found
+        //! @param board board to solve problem for
+        //! @param func function called with number of half-moves and
+        //! every solution in that number of half-moves, fewest first;
+        //! the solution is only valid during the call
+        //! @param shortest true to stop after the fewest half-moves
+        //! which have solutions
+        //! @result fewest number of half-moves which have solutions
+        //! (0 if there are no solutions)
+        //! The number of half-moves is tried from the smallest one
+        //! of the same parity as the full stipulation (1 for
+        //! directmates, 2 for helpmates) up to the full one, sharing
+        //! the transposition table between the attempts, so the full
+        //! problem is solved in about the same time as with solve().
+        //! Solution trees are freed after every key move, as with
+        //! solve(board, func).
+        template <typename Func>
+        unsigned solve_iteratively(const Board &board, Func func,
+                                   bool shortest = false) const
+        {
+            const std::shared_ptr<const Board> root{
+                std::make_shared<const Board>(board)
+            };
+            auto pass = [&](unsigned depth, Solution::list &&sl) {
+                sl.board(root);
+                func(depth, *sl.begin());
+            };
+            return iterate(board, false, shortest, pass);
+        }
+
+        //! Find key moves of chess composition problem with given board
+        //! in fewer moves first, passing every key move as soon
+        //! as it is found
+        //! @param board board to solve problem for
+        //! @param func function called with number of half-moves and
+        //! every solution without continuations in that number of
+        //! half-moves, fewest first; the solution is only valid
+        //! during the call
+        //! @param shortest true to stop after the fewest half-moves
+        //! which have solutions
+        //! @result fewest number of half-moves which have solutions
+        //! (0 if there are no solutions)
+        template <typename Func>
+        unsigned solve_keys_iteratively(const Board &board, Func func,
+                                        bool shortest = false) const
+        {
+            const std::shared_ptr<const Board> root{
+                std::make_shared<const Board>(board)
+            };
+            auto pass = [&](unsigned depth, Solution::list &&sl) {
+                sl.board(root);
+                func(depth, *sl.begin());
+            };
+            return iterate(board, true, shortest, pass);
+        }
+
+        //! Count solutions of chess composition problem with given board
+        //! @param board board to solve problem for
+        //! @param limit number of solutions to stop at (0 means no limit)
+        //! @result number of solutions (key moves), at most limit
+        //! Solving stops as soon as limit solutions are found,
+        //! and no solution trees are built. For example, limit 2
+        //! is enough to tell sound problems from cooked ones.
+        unsigned count_solutions(const Board &board, unsigned limit) const {
+            if (threat_to_king(board))
+                return 0;
+            // The first step of every stipulation accepts any move
+            // which has solution, so just count such moves.
+            unsigned count = 0;
+            SolverListIterator solvp{solvlist_.begin()};
+            ++solvp;
+            Board root{board};
+            with_context(solvp->depth() + 1, solvp->depth(),
+                         [&](Context &ctx) {
+                CountVisitor visit{solvp, ctx, limit};
+                SolverFunc<CountVisitor>{root, solvlist_.front().checks()}(
+                    visit
+                );
+                count = visit.count();
+            });
+            return count;
+        }
+
+        //! Check whether chess composition problem has a solution
+        //! @param board board to solve problem for
+        //! @result true if solution exists
+        bool exists(const Board &board) const {
+            Requirement::Result res{
+                run(board, solvlist_.front().depth() + 1)
+            };
+            return boost::get<Solution::list>(&res) != nullptr;
+        }
+
+        //! Check whether mate picture of helpmate may be reached
+        //! @param board board to solve problem for
+        //! @return false if no mate picture may be reached
+        //! in the moves of the problem (see intelligent()),
+        //! true otherwise and for other stipulations
+        bool mate_feasible(const Board &board) const {
+            return
+                directmate_ ||
+                mate_feasible(board, solvlist_.front().depth());
+        }
+
+        //! Decide whether directmate has a solution
+        //! with proof-number search
+        //! @param board board to solve problem for
+        //! @param work set to the number of positions expanded
+        //! by the search (1 if the initial position is solved
+        //! by depth-first search at once)
+        //! @return proof and disproof numbers of the initial position:
+        //! the proof number is 0 if solution exists, and the disproof
+        //! number is 0 otherwise
+        //! Throws std::logic_error unless proof_number_search() is true.
+        ProofNumberTable::Numbers prove(const Board &board,
+                                        std::uint32_t &work) const
+        {
+            if (!proof_number_search())
+                throw std::logic_error{"proof-number search is not used"};
+            work = 0;
+            ProofNumberTable::Numbers numbers{proof_infinity, 0};
+            if (threat_to_king(board))
+                return numbers;
+            const unsigned depth{solvlist_.front().depth()};
+            Board root{board};
+            with_context(depth + 1, depth, [&](Context &ctx) {
+                numbers = prove(root, solvlist_.begin(), ctx,
+                                proof_infinity, proof_infinity, work);
+            });
+            return numbers;
         }
 
     };
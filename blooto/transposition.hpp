@@ -0,0 +1,227 @@
+// This file is part of Blooto.
+//
+// Blooto is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Blooto is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _BLOOTO_TRANSPOSITION_HPP
+#define _BLOOTO_TRANSPOSITION_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace blooto {
+
+    //! Fixed-size cache of solver outcomes keyed by position hash.
+
+    //! The table is an array of buckets, each one occupying
+    //! a single cache line and holding several entries.
+    //! Every entry maps a pair of position hash and remaining depth
+    //! to the outcome of solving that position with that depth
+    //! and a 32-bit value kept along with it.
+    //! When a bucket is full, the entry with the smallest depth
+    //! (the cheapest one to recompute) is replaced.
+    //! The table may be shared by several threads without locking:
+    //! each entry keeps its data and its key XOR-ed with the data,
+    //! so an entry torn by concurrent stores doesn't match any key.
+    //! Data are stored with release and loaded with acquire semantics,
+    //! so whatever the value refers to is visible to other threads
+    //! once they find the entry.
+    //! On Linux the table is backed by huge pages when possible.
+    //! See https://chessprogramming.wikispaces.com/Transposition+Table
+    //! and https://chessprogramming.wikispaces.com/Shared+Hash+Table
+    //! for more details.
+    class TranspositionTable {
+    public:
+        //! Outcome of solving a position
+        enum class Outcome: std::uint8_t {
+            Unknown,    //!< position is not in the table
+            NotFound,   //!< no solution exists
+            Found       //!< solution exists
+        };
+
+    private:
+        struct Entry {
+            std::atomic<std::uint64_t> check;
+            std::atomic<std::uint64_t> data;
+        };
+
+        static constexpr std::size_t cache_line = 64;
+        static constexpr std::size_t huge_page = std::size_t(2) << 20;
+        static constexpr std::size_t bucket_size =
+            cache_line / sizeof(Entry);
+
+        struct Bucket {
+            Entry entries[bucket_size];
+        };
+
+        static std::uint64_t pack(unsigned depth, Outcome outcome,
+                                  std::uint32_t value)
+        {
+            return (std::uint64_t(value) << 32) |
+                   (std::uint64_t(depth & 0xffffff) << 8) |
+                   std::uint8_t(outcome);
+        }
+
+        static unsigned unpack_depth(std::uint64_t data) {
+            return (data >> 8) & 0xffffff;
+        }
+
+        static std::uint32_t unpack_value(std::uint64_t data) {
+            return data >> 32;
+        }
+
+        static Outcome unpack_outcome(std::uint64_t data) {
+            return Outcome(data & 0xff);
+        }
+
+        // Allocate zero-filled memory
+        static char *allocate(std::size_t bytes) {
+#ifdef __linux__
+            void *p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED)
+                throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+            madvise(p, bytes, MADV_HUGEPAGE);
+#endif
+            return static_cast<char *>(p);
+#else
+            return new char[bytes]();
+#endif
+        }
+
+        static void deallocate(char *p, std::size_t bytes) {
+#ifdef __linux__
+            munmap(p, bytes);
+#else
+            delete[] p;
+#endif
+        }
+
+        char *storage_;
+        std::size_t storage_size_;
+        Bucket *buckets_;
+        std::size_t mask_;
+
+        Bucket &bucket(std::uint64_t key) const {
+            return buckets_[key & mask_];
+        }
+
+    public:
+        //! Default table size in bytes
+        static constexpr std::size_t default_size = std::size_t(16) << 20;
+
+        //! Construct empty table
+        //! @param size table size in bytes (rounded down to power of two)
+        explicit TranspositionTable(std::size_t size = default_size) {
+            std::size_t num_buckets = 1;
+            while (num_buckets * 2 * sizeof(Bucket) <= size)
+                num_buckets *= 2;
+            mask_ = num_buckets - 1;
+            const std::size_t table_size = num_buckets * sizeof(Bucket);
+            const std::size_t alignment =
+                table_size >= huge_page ? huge_page : cache_line;
+            storage_size_ = table_size + alignment;
+            storage_ = allocate(storage_size_);
+            void *p = storage_;
+            std::size_t space = storage_size_;
+            buckets_ = static_cast<Bucket *>(
+                std::align(alignment, table_size, p, space)
+            );
+            for (std::size_t i = 0; i < num_buckets; ++i)
+                new (&buckets_[i]) Bucket;
+        }
+
+        TranspositionTable(const TranspositionTable &) = delete;
+        TranspositionTable &operator=(const TranspositionTable &) = delete;
+
+        ~TranspositionTable() {deallocate(storage_, storage_size_);}
+
+        //! Number of entries the table can hold
+        //! @return table capacity
+        std::size_t capacity() const {return (mask_ + 1) * bucket_size;}
+
+        //! Find outcome of solving a position
+        //! @param key position hash
+        //! @param depth remaining depth
+        //! @param value set to the value stored with the outcome
+        //! (unchanged if the position is not in the table)
+        //! @return stored outcome or Outcome::Unknown
+        Outcome probe(std::uint64_t key, unsigned depth,
+                      std::uint32_t &value) const
+        {
+            for (const Entry &entry: bucket(key).entries) {
+                std::uint64_t data =
+                    entry.data.load(std::memory_order_acquire);
+                std::uint64_t check =
+                    entry.check.load(std::memory_order_relaxed);
+                if ((check ^ data) == key && unpack_depth(data) == depth) {
+                    value = unpack_value(data);
+                    return unpack_outcome(data);
+                }
+            }
+            return Outcome::Unknown;
+        }
+
+        //! Find outcome of solving a position
+        //! @param key position hash
+        //! @param depth remaining depth
+        //! @return stored outcome or Outcome::Unknown
+        Outcome probe(std::uint64_t key, unsigned depth) const {
+            std::uint32_t value;
+            return probe(key, depth, value);
+        }
+
+        //! Remember outcome of solving a position
+        //! @param key position hash
+        //! @param depth remaining depth (less than 2^24)
+        //! @param outcome outcome to remember
+        //! @param value value to keep with the outcome
+        void store(std::uint64_t key, unsigned depth, Outcome outcome,
+                   std::uint32_t value = 0)
+        {
+            Bucket &b = bucket(key);
+            Entry *victim = &b.entries[0];
+            unsigned victim_depth = ~0u;
+            for (Entry &entry: b.entries) {
+                std::uint64_t data =
+                    entry.data.load(std::memory_order_relaxed);
+                std::uint64_t check =
+                    entry.check.load(std::memory_order_relaxed);
+                if (unpack_outcome(data) == Outcome::Unknown ||
+                    ((check ^ data) == key && unpack_depth(data) == depth))
+                {
+                    victim = &entry;
+                    break;
+                }
+                if (unpack_depth(data) < victim_depth) {
+                    victim = &entry;
+                    victim_depth = unpack_depth(data);
+                }
+            }
+            std::uint64_t data = pack(depth, outcome, value);
+            victim->check.store(key ^ data, std::memory_order_relaxed);
+            victim->data.store(data, std::memory_order_release);
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,87 @@
+// This file is part of Blooto.
+//
+// Blooto is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Blooto is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _BLOOTO_ZOBRIST_HPP
+#define _BLOOTO_ZOBRIST_HPP
+
+#include <cstdint>
+
+#include <blooto/square.hpp>
+
+namespace blooto {
+
+    //! Random keys for Zobrist hashing of chess positions.
+
+    //! Position hash is XOR of keys of all pieces on the board
+    //! (one key for every combination of piece code, colour and square)
+    //! and of colour key if black is to move.
+    //! See https://chessprogramming.wikispaces.com/Zobrist+Hashing
+    //! for more details.
+    //! @param NumCodes number of distinct piece codes
+    template <unsigned NumCodes> class Zobrist {
+        std::uint64_t pieces_[NumCodes][3][64];
+        std::uint64_t colour_;
+
+        // SplitMix64 generator: fixed seed, so keys are the same in every run
+        static std::uint64_t next(std::uint64_t &state) {
+            std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        }
+
+        Zobrist() {
+            std::uint64_t state = 0;
+            for (auto &colours: pieces_)
+                for (auto &squares: colours)
+                    for (auto &key: squares)
+                        key = next(state);
+            colour_ = next(state);
+        }
+
+        static const Zobrist &instance() {
+            static Zobrist inst;
+            return inst;
+        }
+
+    public:
+        //! Index of white pieces' keys
+        static constexpr unsigned white = 0;
+
+        //! Index of black pieces' keys
+        static constexpr unsigned black = 1;
+
+        //! Index of neutral pieces' keys
+        static constexpr unsigned neutral = 2;
+
+        //! Key of a piece
+        //! @param code piece code
+        //! @param colour colour index (white, black or neutral)
+        //! @param square square where the piece is located
+        //! @return key to XOR into position hash
+        static std::uint64_t piece(unsigned code, unsigned colour,
+                                   Square square)
+        {
+            return instance().pieces_[code][colour][blooto::code(square)];
+        }
+
+        //! Key of the move colour
+        //! @return key to XOR into position hash if black is to move
+        static std::uint64_t colour() {return instance().colour_;}
+    };
+
+}
+
+#endif
@@ -28,8 +28,10 @@ BOOST_AUTO_TEST_CASE(test_bitboard) {
     std::initializer_list<blooto::Square> empty_il{};
     BOOST_CHECK_EQUAL_COLLECTIONS(empty_bb.begin(), empty_bb.end(),
                                   empty_il.begin(), empty_il.end());
+    BOOST_CHECK_EQUAL(empty_bb.count(), 0u);
     blooto::BitBoard all_bb(~empty_bb);
     BOOST_CHECK(all_bb[blooto::Square::A1]);
+    BOOST_CHECK_EQUAL(all_bb.count(), 64u);
     blooto::BitBoard d4_bb(blooto::Square::D4);
     BOOST_CHECK(!d4_bb[blooto::Square::A1]);
     BOOST_CHECK(d4_bb[blooto::Square::D4]);
@@ -41,6 +43,7 @@ BOOST_AUTO_TEST_CASE(test_bitboard) {
     BOOST_CHECK(!b2_f6_bb[blooto::Square::D4]);
     BOOST_CHECK(b2_f6_bb[blooto::Square::B2]);
     BOOST_CHECK(b2_f6_bb[blooto::Square::F6]);
+    BOOST_CHECK_EQUAL(b2_f6_bb.count(), 2u);
     std::initializer_list<blooto::Square> b2_f6_il{
         blooto::Square::B2,
         blooto::Square::F6
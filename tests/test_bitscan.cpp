@@ -64,3 +64,16 @@ BOOST_AUTO_TEST_CASE(test_bitscan) {
     n4 &= n4 ^ (0 - n4);
     BOOST_CHECK_EQUAL(n4, 0ULL);
 }
+
+BOOST_AUTO_TEST_CASE(test_popcount) {
+    using namespace blooto;
+    for (std::uint64_t n: {0ULL, 1ULL, 10ULL, 0x1008020400802300ULL,
+                           0x8000000000000001ULL, ~0ULL})
+    {
+        unsigned count = 0;
+        for (std::uint64_t m = n; m != 0; m &= m - 1)
+            ++count;
+        BOOST_CHECK_EQUAL(BitScanGeneric::popcount(n), count);
+        BOOST_CHECK_EQUAL(BitScanOptimised::popcount(n), count);
+    }
+}
@@ -13,8 +13,11 @@
 // You should have received a copy of the GNU General Public License
 // along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
+#include <cstdint>
 #include <initializer_list>
 #include <string>
+#include <vector>
 #include <boost/lexical_cast.hpp>
 
 #include <blooto/board.hpp>
@@ -27,6 +30,7 @@
 #include <blooto/queentype.hpp>
 #include <blooto/kingtype.hpp>
 #include <blooto/move.hpp>
+#include <blooto/movelist.hpp>
 
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE test_board
@@ -424,3 +428,305 @@ BOOST_AUTO_TEST_CASE(test_board) {
     BOOST_CHECK_EQUAL_COLLECTIONS(board.moves().begin(), board.moves().end(),
                                   moves5.begin(), moves5.end());
 }
+
+BOOST_AUTO_TEST_CASE(test_board_hash) {
+    using namespace blooto;
+    Board board{
+        boost::lexical_cast<Board>("Neutral Bb1 White Bd3 Kh7 Black Pg2 Bf5")
+    };
+    Board board2{board};
+    BOOST_CHECK(board == board2);
+    BOOST_CHECK_EQUAL(board.hash(), board2.hash());
+    board.make_move(Square::D3, Square::F5);
+    BOOST_CHECK(board != board2);
+    Board expected1{
+        boost::lexical_cast<Board>("Neutral Bb1 White Bf5 Kh7 Black Pg2")
+    };
+    BOOST_CHECK(board == expected1);
+    BOOST_CHECK_EQUAL(board.hash(), expected1.hash());
+    board.flip_colour();
+    BOOST_CHECK(board != expected1);
+    BOOST_CHECK(board.hash() != expected1.hash());
+    board.take_piece(Square::G2);
+    board.put_piece<PawnType>(Square::G1, false);
+    board.make_promotion(Square::G1, KnightType::instance);
+    board.take_piece(Square::B1);
+    board.put_piece<BishopType>(Square::F5, true);
+    board.flip_colour();
+    Board expected2{
+        boost::lexical_cast<Board>("Neutral Bf5 White Kh7 Black Sg1")
+    };
+    BOOST_CHECK(board == expected2);
+    BOOST_CHECK_EQUAL(board.hash(), expected2.hash());
+    board.make_move(Square::F5, Square::G4);
+    board.make_move(Square::G4, Square::F5);
+    BOOST_CHECK(board == expected2);
+    BOOST_CHECK_EQUAL(board.hash(), expected2.hash());
+    board.make_move(Move{KingType::instance, Square::H7, Square::H8});
+    board.make_move(Move{KingType::instance, Square::H8, Square::H7});
+    BOOST_CHECK(board == expected2);
+    BOOST_CHECK_EQUAL(board.hash(), expected2.hash());
+}
+
+BOOST_AUTO_TEST_CASE(test_board_attackers) {
+    using namespace blooto;
+    Board board{
+        boost::lexical_cast<Board>(
+            "White Ke1 Rh1 Pd2 Sf3 Black Ke8 Qa5 Pf2 Bb4"
+        )
+    };
+    const BitBoard occupied{board.occupied()};
+    BOOST_CHECK((board.attackers(Square::E1, ColourBlack(), occupied) &
+                 board.unfriendlies()) == BitBoard{Square::F2});
+    BOOST_CHECK((board.attackers(Square::E1, ColourBlack(),
+                                 occupied & ~Square::D2) &
+                 board.unfriendlies()) == (Square::F2 | Square::B4));
+    BOOST_CHECK((board.attackers(Square::E8, ColourWhite(), occupied) &
+                 board.friendlies()).empty());
+    BOOST_CHECK((board.attackers(Square::F2, ColourWhite(), occupied) &
+                 board.friendlies()) == BitBoard{Square::E1});
+    BOOST_CHECK((board.attackers(Square::G1, ColourWhite(), occupied) &
+                 board.friendlies()) == (Square::H1 | Square::F3));
+    BOOST_CHECK((board.attackers(Square::E3, ColourWhite(), occupied) &
+                 board.friendlies()) == BitBoard{Square::D2});
+    BOOST_CHECK(Board::between(Square::A1, Square::D4) ==
+                (Square::B2 | Square::C3));
+    BOOST_CHECK(Board::between(Square::E8, Square::E5) ==
+                (Square::E7 | Square::E6));
+    BOOST_CHECK(Board::between(Square::B1, Square::C3).empty());
+    BOOST_CHECK(Board::between(Square::E1, Square::F2).empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_board_checks) {
+    using namespace blooto;
+    Board board{
+        boost::lexical_cast<Board>("White Ka1 Rd1 Sd5 Pg7 Black Kd8")
+    };
+    BitBoard rook_checks{
+        board.check_squares<RookType>(Square::D1, Square::D8)
+    };
+    BOOST_CHECK(rook_checks[Square::D5]);
+    BOOST_CHECK(rook_checks[Square::A8]);
+    BOOST_CHECK(!rook_checks[Square::D4]);
+    BitBoard knight_checks{
+        board.check_squares<KnightType>(Square::D5, Square::D8)
+    };
+    BOOST_CHECK(knight_checks == (Square::C6 | Square::E6 |
+                                  Square::B7 | Square::F7));
+    BOOST_CHECK(board.check_squares(QueenType::instance,
+                                    Square::G7, Square::D8)[Square::G8]);
+    BOOST_CHECK(board.check_squares(RookType::instance,
+                                    Square::G7, Square::D8)[Square::G8]);
+    BOOST_CHECK(!board.check_squares(BishopType::instance,
+                                     Square::G7, Square::D8)[Square::G8]);
+    BOOST_CHECK(!board.check_squares(KnightType::instance,
+                                     Square::G7, Square::D8)[Square::G8]);
+    BOOST_CHECK(board.discoverers(Square::D8) == BitBoard{Square::D5});
+    BOOST_CHECK(board.discovers_check(Square::D5, Square::C7, Square::D8));
+    BOOST_CHECK(!board.discovers_check(Square::D5, Square::D7, Square::D8));
+}
+
+BOOST_AUTO_TEST_CASE(test_board_legality) {
+    using namespace blooto;
+    Board board{
+        boost::lexical_cast<Board>("White Ke1 Re2 Sd2 Black Ke8 Re5 Ba5")
+    };
+    Board::Legality legality{board};
+    BOOST_CHECK(legality.exact());
+    BOOST_CHECK(!legality.check());
+    BOOST_CHECK(legality.legal(Square::E2, ~BitBoard{Square::E2}) ==
+                (Square::E3 | Square::E4 | Square::E5));
+    BOOST_CHECK(legality.legal(Square::D2, Square::B1 | Square::B3 |
+                               Square::C4 | Square::E4 | Square::F3 |
+                               Square::F1).empty());
+    BOOST_CHECK(legality.legal(Square::E1, ~BitBoard{})[Square::F1]);
+    Board check{
+        boost::lexical_cast<Board>("White Ke1 Rh2 Sc3 Black Ke8 Qe5")
+    };
+    Board::Legality evasions{check};
+    BOOST_CHECK(evasions.check());
+    BOOST_CHECK(evasions.legal(Square::H2, ~BitBoard{}) ==
+                (Square::E2 | Square::E3 | Square::E4 | Square::E5));
+    BOOST_CHECK(evasions.legal(Square::C3, Square::E2 | Square::E4 |
+                               Square::D5 | Square::B5) ==
+                (Square::E2 | Square::E4));
+    BOOST_CHECK(!evasions.legal(Square::E1, ~BitBoard{})[Square::E2]);
+    Board neutral{
+        boost::lexical_cast<Board>("White Ke1 Neutral Rd4 Black Ke8")
+    };
+    BOOST_CHECK(!Board::Legality{neutral}.exact());
+}
+
+BOOST_AUTO_TEST_CASE(test_board_king_attacked) {
+    using namespace blooto;
+    auto attacked = [](const char *position) {
+        return boost::lexical_cast<Board>(position).unfriendly_king_attacked();
+    };
+    BOOST_CHECK(attacked("White Ka1 Bb2 Black Kh8"));
+    BOOST_CHECK(!attacked("White Ka1 Bb2 Black Kh8 Pg7"));
+    BOOST_CHECK(attacked("White Ka1 Pd4 Black Ke5"));
+    BOOST_CHECK(!attacked("White Ka1 Pd6 Black Ke5"));
+    BOOST_CHECK(attacked("White Ka1 Neutral Sf7 Black Kh8"));
+    BOOST_CHECK(!attacked("White Ka1 Black Kh8 Sf7"));
+}
+
+BOOST_AUTO_TEST_CASE(test_board_do_undo) {
+    using namespace blooto;
+    const Board board{
+        boost::lexical_cast<Board>(
+            "White Ka1 Pb7 Rd1 Black Kh8 Qc8 Neutral Bd5 Pg2")
+    };
+    for (const auto &move: board.moves()) {
+        Board copy{board};
+        copy.make_move(move.from(), move.to());
+        if (move.promotion())
+            copy.make_promotion(move.to(), *move.promotion());
+        copy.flip_colour();
+        Board newboard{board};
+        const Board::Undo undo{
+            move.promotion() ?
+            newboard.do_move(move.from(), move.to(), *move.promotion()) :
+            newboard.do_move(move.from(), move.to())
+        };
+        BOOST_CHECK(newboard == copy);
+        newboard.undo_move(move.from(), move.to(), undo);
+        BOOST_CHECK(newboard == board);
+        BOOST_CHECK_EQUAL(newboard.hash(), board.hash());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_board_do_undo_typed) {
+    using namespace blooto;
+    const Board board{
+        boost::lexical_cast<Board>(
+            "White Ka1 Pb7 Pc2 Rd1 Black Kh8 Qc8 Neutral Bd5 Pg2")
+    };
+    for (const auto &move: board.moves()) {
+        if (board.piecetype(move.from()) != &PawnType::instance)
+            continue;
+        const bool neutral{board.neutrals()[move.from()]};
+        Board copy{board};
+        Board newboard{board};
+        if (move.promotion()) {
+            auto p = Board::promotions().begin();
+            while (&*p != move.promotion())
+                ++p;
+            copy.do_move(move.from(), move.to(), *p);
+            const Board::Undo undo{
+                newboard.do_move<PawnType>(move.from(), move.to(), neutral,
+                                           p)
+            };
+            BOOST_CHECK(newboard == copy);
+            BOOST_CHECK_EQUAL(newboard.hash(), copy.hash());
+            newboard.undo_move(move.from(), move.to(), undo);
+        } else {
+            copy.do_move(move.from(), move.to());
+            const Board::Undo undo{
+                newboard.do_move<PawnType>(move.from(), move.to(), neutral)
+            };
+            BOOST_CHECK(newboard == copy);
+            BOOST_CHECK_EQUAL(newboard.hash(), copy.hash());
+            newboard.undo_move(move.from(), move.to(), undo);
+        }
+        BOOST_CHECK(newboard == board);
+        BOOST_CHECK_EQUAL(newboard.hash(), board.hash());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_board_moves_from) {
+    using namespace blooto;
+    for (const char *position: {
+            "White Ka1 Qd4 Rh1 Bc1 Sb1 Pe2 Pg7 Black Kh8 Pd5 Pf3",
+            "Black Ka1 Qd4 Rh1 Bc1 Sb1 Pe2 Pg7 White Kh8 Pd5 Pf3"})
+    {
+        const Board board{boost::lexical_cast<Board>(position)};
+        for (Square square: board.can_move()) {
+            BOOST_CHECK(board.moves_from(square) ==
+                        (board.piecetype(square)->moves(board.colour(),
+                                                        square,
+                                                        board.occupied()) &
+                         ~board.friendlies()));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_board_moves_pawns) {
+    using namespace blooto;
+    // Pawn moves of the iterator are taken from the moves of all pawns
+    // computed at once; they must be the same as square by square
+    for (const char *position: {
+            "White Ke1 Pa2 Pb2 Pc3 Ph2 Pg7 Pb7 Black Kh8 Pa3 Pd4 Ra8 Sc8",
+            "Black Ke8 Pa7 Pb7 Pc6 Ph7 Pg2 Pb2 White Kh1 Pa6 Pd5 Ra1 Sc1",
+            "White Ka1 Pe2 Black Kh8 Pd3 Pf3 Neutral Pe4 Pg7 Pf2"})
+    {
+        const Board board{boost::lexical_cast<Board>(position)};
+        std::vector<Move> expected;
+        for (Square from: board.can_move())
+            for (Square to: board.moves_from(from)) {
+                if (!board.promotes(from, to)) {
+                    expected.push_back(board.move(from, to));
+                    continue;
+                }
+                for (const PieceType &p: Board::promotions())
+                    expected.push_back(board.move(from, to, p));
+            }
+        BOOST_CHECK_EQUAL_COLLECTIONS(board.moves().begin(),
+                                      board.moves().end(),
+                                      expected.begin(), expected.end());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_board_generate) {
+    using namespace blooto;
+    const Board board{
+        boost::lexical_cast<Board>(
+            "White Ka1 Qb3 Rd1 Bb5 Sc6 Pb7 Pe5 Black Kd7 Rc8 Pd6 "
+            "Neutral Bf4")
+    };
+    // Moves are generated by piece type rather than by square,
+    // so they are compared regardless of order
+    MoveList all;
+    board.generate(all);
+    std::vector<std::uint16_t> generated;
+    for (PackedMove move: all) {
+        BOOST_CHECK(board.pack(board.unpack(move)) == move);
+        generated.push_back(move.data());
+    }
+    std::vector<std::uint16_t> expected;
+    for (const auto &move: board.moves())
+        expected.push_back(board.pack(move).data());
+    std::sort(generated.begin(), generated.end());
+    std::sort(expected.begin(), expected.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(generated.begin(), generated.end(),
+                                  expected.begin(), expected.end());
+    MoveList captures;
+    board.generate_captures(captures);
+    MoveList quiets;
+    board.generate_quiets(quiets);
+    BOOST_CHECK_EQUAL(captures.size() + quiets.size(), all.size());
+    for (PackedMove move: captures)
+        BOOST_CHECK(move.attack());
+    for (PackedMove move: quiets)
+        BOOST_CHECK(!move.attack());
+    MoveList checks;
+    board.generate_checks(checks);
+    std::vector<std::uint16_t> expected_checks;
+    for (const auto &move: board.moves()) {
+        Board newboard{board};
+        newboard.make_move(move.from(), move.to());
+        if (move.promotion())
+            newboard.make_promotion(move.to(), *move.promotion());
+        if (newboard.unfriendly_king_attacked())
+            expected_checks.push_back(board.pack(move).data());
+    }
+    std::vector<std::uint16_t> generated_checks;
+    for (PackedMove move: checks)
+        generated_checks.push_back(move.data());
+    std::sort(expected_checks.begin(), expected_checks.end());
+    std::sort(generated_checks.begin(), generated_checks.end());
+    BOOST_CHECK(!checks.empty());
+    BOOST_CHECK_EQUAL_COLLECTIONS(generated_checks.begin(),
+                                  generated_checks.end(),
+                                  expected_checks.begin(),
+                                  expected_checks.end());
+}
@@ -14,6 +14,7 @@
 // along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <string>
+#include <type_traits>
 #include <boost/lexical_cast.hpp>
 
 #include <blooto/colour.hpp>
@@ -95,3 +96,15 @@ BOOST_AUTO_TEST_CASE(test_movecolour) {
     BOOST_CHECK_EQUAL(mc1, ColourWhite());
     BOOST_CHECK_EQUAL(boost::lexical_cast<std::string>(mc1), "white");
 }
+
+BOOST_AUTO_TEST_CASE(test_colour_opposite) {
+    using namespace blooto;
+    static_assert(std::is_same<decltype(opposite(ColourWhite())),
+                               ColourBlack>::value,
+                  "opposite of white tag must be black tag");
+    static_assert(std::is_same<decltype(opposite(ColourBlack())),
+                               ColourWhite>::value,
+                  "opposite of black tag must be white tag");
+    BOOST_CHECK_EQUAL(opposite(MoveColour{ColourWhite()}), ColourBlack());
+    BOOST_CHECK_EQUAL(opposite(MoveColour{ColourBlack()}), ColourWhite());
+}
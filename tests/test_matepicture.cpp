@@ -0,0 +1,113 @@
+// This file is part of Blooto.
+//
+// Blooto is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Blooto is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <vector>
+
+#include <blooto/matepicture.hpp>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE test_matepicture
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(test_matepicture_attacks) {
+    using namespace blooto;
+    const MatePicture &picture = MatePicture::instance();
+    BOOST_CHECK(picture.attacks<KnightType>(Square::A1, 0) ==
+                (Square::B3 | Square::C2));
+    BitBoard knight{picture.attacks<KnightType>(Square::A1, 1)};
+    BOOST_CHECK(knight[Square::A1]);
+    BOOST_CHECK(knight[Square::D4]);
+    BOOST_CHECK(!knight[Square::B2]);
+    BOOST_CHECK(!knight[Square::H8]);
+    BitBoard bishop{picture.attacks<BishopType>(Square::C1, 5)};
+    BOOST_CHECK(bishop[Square::A3]);
+    BOOST_CHECK(!bishop[Square::B1]);
+    BOOST_CHECK(picture.attacks<RookType>(Square::A1, 1) == ~BitBoard{});
+    BitBoard pawn{picture.attacks<PawnType>(Square::E2, 0)};
+    BOOST_CHECK(pawn == (Square::D3 | Square::F3));
+    // Promoted on the 8th rank, the pawn attacks like a queen
+    BitBoard promoted{picture.attacks<PawnType>(Square::A7, 1)};
+    BOOST_CHECK(promoted[Square::H1]);
+    BOOST_CHECK(promoted[Square::A1]);
+    BOOST_CHECK(picture.attacks<PawnType>(Square::A2, 0) ==
+                BitBoard{Square::B3});
+    BOOST_CHECK(picture.attacks<KingType>(Square::A1, 16) == ~BitBoard{});
+}
+
+BOOST_AUTO_TEST_CASE(test_matepicture_reaches) {
+    using namespace blooto;
+    const MatePicture &picture = MatePicture::instance();
+    BOOST_CHECK(picture.reaches<KingType>(Square::E8, 0) ==
+                BitBoard{Square::E8});
+    BitBoard king{picture.reaches<KingType>(Square::E8, 1)};
+    BOOST_CHECK(king[Square::E8]);
+    BOOST_CHECK(king[Square::D7]);
+    BOOST_CHECK(!king[Square::E6]);
+    BitBoard pawn{picture.reaches<PawnType>(Square::E7, 1)};
+    BOOST_CHECK(pawn[Square::E6]);
+    BOOST_CHECK(pawn[Square::E5]);
+    BOOST_CHECK(!pawn[Square::E4]);
+    BOOST_CHECK(!pawn[Square::E8]);
+    // Black pawn goes to the 1st rank and is promoted there
+    BitBoard promoted{picture.reaches<PawnType>(Square::A2, 2)};
+    BOOST_CHECK(promoted[Square::A1]);
+    BOOST_CHECK(promoted[Square::H8]);
+    BOOST_CHECK(promoted[Square::B3]);
+}
+
+BOOST_AUTO_TEST_CASE(test_matepicture_attacks_after) {
+    using namespace blooto;
+    const MatePicture &picture = MatePicture::instance();
+    // Knight gets to b3 and c2 with a move, and attacks from there
+    std::vector<BitBoard> knight;
+    picture.attacks_after<KnightType>(Square::A1, 1, [&](BitBoard sqs) {
+        knight.push_back(sqs);
+    });
+    BOOST_CHECK_EQUAL(knight.size(), 2);
+    for (BitBoard sqs: knight) {
+        BOOST_CHECK(sqs[Square::A1]);
+        BOOST_CHECK(sqs[Square::E3] != sqs[Square::A5]);
+    }
+    // Squares the king gets to with two moves, but not with one
+    unsigned count = 0;
+    picture.attacks_after<KingType>(Square::A1, 2, [&](BitBoard sqs) {
+        BOOST_CHECK(!sqs[Square::A1]);
+        ++count;
+    });
+    BOOST_CHECK_EQUAL(count, 5);
+    // Pawn attacks every square it may attack after the moves at once
+    count = 0;
+    picture.attacks_after<PawnType>(Square::E2, 1, [&](BitBoard sqs) {
+        BOOST_CHECK(sqs == picture.attacks<PawnType>(Square::E2, 1));
+        ++count;
+    });
+    BOOST_CHECK_EQUAL(count, 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_matepicture_reach_moves) {
+    using namespace blooto;
+    const MatePicture &picture = MatePicture::instance();
+    BOOST_CHECK_EQUAL(
+        picture.reach_moves<KingType>(Square::E8, Square::E8, 3), 0);
+    BOOST_CHECK_EQUAL(
+        picture.reach_moves<KingType>(Square::E8, Square::E6, 3), 2);
+    BOOST_CHECK_EQUAL(
+        picture.reach_moves<KingType>(Square::E8, Square::E1, 3), 4);
+    BOOST_CHECK_EQUAL(
+        picture.reach_moves<BishopType>(Square::C8, Square::B5, 3), 2);
+    // Bishop never gets to squares of the other colour
+    BOOST_CHECK_EQUAL(
+        picture.reach_moves<BishopType>(Square::C8, Square::D6, 3), 4);
+}
@@ -0,0 +1,54 @@
+// This file is part of Blooto.
+//
+// Blooto is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Blooto is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <blooto/packedmove.hpp>
+#include <blooto/movelist.hpp>
+#include <blooto/square.hpp>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE test_packedmove
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(test_packedmove) {
+    using namespace blooto;
+    PackedMove m1{Square::B2, Square::D4};
+    BOOST_CHECK_EQUAL(m1.from(), Square::B2);
+    BOOST_CHECK_EQUAL(m1.to(), Square::D4);
+    BOOST_CHECK(!m1.attack());
+    BOOST_CHECK_EQUAL(m1.promotion(), 0u);
+    PackedMove m2{Square::H7, Square::G8, true, 4};
+    BOOST_CHECK_EQUAL(m2.from(), Square::H7);
+    BOOST_CHECK_EQUAL(m2.to(), Square::G8);
+    BOOST_CHECK(m2.attack());
+    BOOST_CHECK_EQUAL(m2.promotion(), 4u);
+    BOOST_CHECK(m1 != m2);
+    BOOST_CHECK(m2 == (PackedMove{Square::H7, Square::G8, true, 4}));
+}
+
+BOOST_AUTO_TEST_CASE(test_movelist) {
+    using namespace blooto;
+    MoveList list;
+    BOOST_CHECK(list.empty());
+    list.push_back(PackedMove{Square::A1, Square::A8});
+    list.push_back(PackedMove{Square::E2, Square::E4});
+    BOOST_CHECK_EQUAL(list.size(), 2u);
+    BOOST_CHECK(list[1] == (PackedMove{Square::E2, Square::E4}));
+    BOOST_CHECK_EQUAL(list.end() - list.begin(), 2);
+    list.clear();
+    for (std::size_t i = 0; i < MoveList::capacity; ++i)
+        list.push_back(PackedMove{Square::A1, Square::A2});
+    BOOST_CHECK_THROW(list.push_back(PackedMove{Square::A1, Square::A2}),
+                      std::length_error);
+}
@@ -234,3 +234,37 @@ BOOST_AUTO_TEST_CASE(test_piece) {
                           Piece::ParseError,
                           ExpectWhat("Wrong piece position: Qq1"));
 }
+
+BOOST_AUTO_TEST_CASE(test_piece_pawns) {
+    using namespace blooto;
+    const BitBoard white{Square::A2 | Square::D2 | Square::H5 | Square::E7};
+    const BitBoard black{Square::B3 | Square::D3 | Square::G6 | Square::A7};
+    const BitBoard occupancy{white | black};
+    for (Square square: white) {
+        BOOST_CHECK(PawnType::instance.moves(ColourWhite(), square,
+                                             occupancy) ==
+                    PawnType::instance.moves(MoveColour{ColourWhite()},
+                                             square, occupancy));
+    }
+    for (Square square: black) {
+        BOOST_CHECK(PawnType::instance.moves(ColourBlack(), square,
+                                             occupancy) ==
+                    PawnType::instance.moves(MoveColour{ColourBlack()},
+                                             square, occupancy));
+    }
+    const PawnType::Moves<ColourWhite> moves{
+        ColourWhite(), white, occupancy, ~white
+    };
+    BOOST_CHECK(moves.origins() ==
+                (Square::A2 | Square::H5 | Square::E7));
+    BOOST_CHECK(moves.from(Square::A2) ==
+                (Square::A3 | Square::A4 | Square::B3));
+    BOOST_CHECK(moves.from(Square::D2).empty());
+    BOOST_CHECK(moves.from(Square::H5) == (Square::H6 | Square::G6));
+    BOOST_CHECK(moves.from(Square::E7) == BitBoard{Square::E8});
+    BOOST_CHECK(PawnType::promotion_rank(ColourWhite())[Square::E8]);
+    BOOST_CHECK(PawnType::instance.can_be_promoted(ColourBlack(),
+                                                   Square::A1));
+    BOOST_CHECK(!PawnType::instance.can_be_promoted(ColourBlack(),
+                                                    Square::A8));
+}
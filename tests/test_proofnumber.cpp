@@ -0,0 +1,65 @@
+// This file is part of Blooto.
+//
+// Blooto is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Blooto is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <blooto/proofnumber.hpp>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE test_proofnumber
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(test_proofnumber) {
+    using namespace blooto;
+    using Numbers = ProofNumberTable::Numbers;
+    const auto infinity = ProofNumberTable::infinity;
+    ProofNumberTable table;
+    Numbers numbers{1, 1};
+    BOOST_CHECK(!table.probe(0x1234, 3, numbers));
+    BOOST_CHECK_EQUAL(numbers.proof, 1u);
+    BOOST_CHECK_EQUAL(numbers.disproof, 1u);
+    table.store(0x1234, 3, Numbers{5, 7}, 10);
+    table.store(0x1234, 2, Numbers{0, infinity}, 1);
+    BOOST_CHECK(table.probe(0x1234, 3, numbers));
+    BOOST_CHECK_EQUAL(numbers.proof, 5u);
+    BOOST_CHECK_EQUAL(numbers.disproof, 7u);
+    BOOST_CHECK(table.probe(0x1234, 2, numbers));
+    BOOST_CHECK_EQUAL(numbers.proof, 0u);
+    BOOST_CHECK_EQUAL(numbers.disproof, infinity);
+    BOOST_CHECK(!table.probe(0x1234, 1, numbers));
+    BOOST_CHECK(!table.probe(0x4321, 3, numbers));
+    table.store(0x1234, 3, Numbers{infinity, 0}, 20);
+    BOOST_CHECK(table.probe(0x1234, 3, numbers));
+    BOOST_CHECK_EQUAL(numbers.proof, infinity);
+    BOOST_CHECK_EQUAL(numbers.disproof, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_proofnumber_replace) {
+    using namespace blooto;
+    using Numbers = ProofNumberTable::Numbers;
+    ProofNumberTable table{128};
+    BOOST_CHECK_EQUAL(table.capacity(), 4);
+    table.store(1, 5, Numbers{1, 2}, 50);
+    table.store(2, 2, Numbers{1, 2}, 20);
+    table.store(3, 7, Numbers{1, 2}, 70);
+    table.store(4, 4, Numbers{1, 2}, 40);
+    table.store(5, 6, Numbers{3, 4}, 1);
+    Numbers numbers;
+    BOOST_CHECK(table.probe(1, 5, numbers));
+    BOOST_CHECK(!table.probe(2, 2, numbers));
+    BOOST_CHECK(table.probe(3, 7, numbers));
+    BOOST_CHECK(table.probe(4, 4, numbers));
+    BOOST_CHECK(table.probe(5, 6, numbers));
+    BOOST_CHECK_EQUAL(numbers.proof, 3u);
+    BOOST_CHECK_EQUAL(numbers.disproof, 4u);
+}
@@ -0,0 +1,53 @@
+// This file is part of Blooto.
+//
+// Blooto is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Blooto is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <blooto/refutation.hpp>
+#include <blooto/square.hpp>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE test_refutation
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(test_refutation) {
+    using namespace blooto;
+    RefutationTable table{3};
+    BOOST_CHECK_EQUAL(table.score(2, Square::E7, Square::E5), 0u);
+    table.refuted(2, Square::E7, Square::E5);
+    BOOST_CHECK_EQUAL(table.score(2, Square::E7, Square::E5),
+                      RefutationTable::killer_score());
+    BOOST_CHECK_EQUAL(table.score(1, Square::E7, Square::E5), 0u);
+    table.refuted(2, Square::G8, Square::F6);
+    BOOST_CHECK_EQUAL(table.score(2, Square::G8, Square::F6),
+                      RefutationTable::killer_score());
+    BOOST_CHECK_EQUAL(table.score(2, Square::E7, Square::E5),
+                      RefutationTable::killer_score() - 1);
+    table.refuted(2, Square::G8, Square::F6);
+    BOOST_CHECK_EQUAL(table.score(2, Square::E7, Square::E5),
+                      RefutationTable::killer_score() - 1);
+    table.refuted(2, Square::D7, Square::D5);
+    table.refuted(2, Square::B8, Square::C6);
+    // Moves which are no longer killers are ordered by history
+    const std::uint32_t e5{table.score(2, Square::E7, Square::E5)};
+    const std::uint32_t f6{table.score(2, Square::G8, Square::F6)};
+    BOOST_CHECK_GT(e5, 0u);
+    BOOST_CHECK_GT(f6, e5);
+    BOOST_CHECK_LT(f6, RefutationTable::killer_score() - 1);
+    // Refutations at greater depths weigh more
+    table.refuted(1, Square::E7, Square::E5);
+    table.refuted(1, Square::D7, Square::D5);
+    table.refuted(1, Square::B8, Square::C6);
+    BOOST_CHECK_GT(table.score(1, Square::E7, Square::E5), 0u);
+    BOOST_CHECK_LT(table.score(1, Square::E7, Square::E5), e5);
+}
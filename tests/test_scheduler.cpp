@@ -0,0 +1,85 @@
+// This file is part of Blooto.
+//
+// Blooto is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Blooto is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include <blooto/scheduler.hpp>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE test_scheduler
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(test_scheduler) {
+    using namespace blooto;
+    Scheduler scheduler{4};
+    BOOST_CHECK_EQUAL(scheduler.size(), 4u);
+    BOOST_CHECK_EQUAL(scheduler.current(), 0u);
+    std::atomic<unsigned> count{0};
+    std::atomic<bool> outside{false};
+    Scheduler::TaskGroup group;
+    for (unsigned i = 0; i < 100; ++i)
+        scheduler.spawn(group, [&]() {
+            if (scheduler.current() >= scheduler.size())
+                outside = true;
+            ++count;
+        });
+    scheduler.wait(group);
+    BOOST_CHECK_EQUAL(count.load(), 100u);
+    BOOST_CHECK(!outside);
+}
+
+BOOST_AUTO_TEST_CASE(test_scheduler_exception) {
+    using namespace blooto;
+    Scheduler scheduler{4};
+    Scheduler::TaskGroup group;
+    for (unsigned i = 0; i < 100; ++i)
+        scheduler.spawn(group, [&, i]() {
+            // Exception thrown by nested group goes up as well
+            Scheduler::TaskGroup inner{&group};
+            scheduler.spawn(inner, [i]() {
+                if (i == 50)
+                    throw std::length_error{"test"};
+            });
+            scheduler.wait(inner);
+        });
+    BOOST_CHECK_THROW(scheduler.wait(group), std::length_error);
+    BOOST_CHECK(group.cancelled());
+    // Scheduler is still usable after the exception
+    std::atomic<unsigned> count{0};
+    Scheduler::TaskGroup other;
+    for (unsigned i = 0; i < 10; ++i)
+        scheduler.spawn(other, [&]() {++count;});
+    scheduler.wait(other);
+    BOOST_CHECK_EQUAL(count.load(), 10u);
+}
+
+BOOST_AUTO_TEST_CASE(test_scheduler_wait_blocked) {
+    using namespace blooto;
+    Scheduler scheduler{4};
+    // Waiting threads run out of queued tasks long before the tasks
+    // are done, so they block and have to be woken up
+    std::atomic<unsigned> count{0};
+    Scheduler::TaskGroup group;
+    for (unsigned i = 0; i < 8; ++i)
+        scheduler.spawn(group, [&]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds{20});
+            ++count;
+        });
+    scheduler.wait(group);
+    BOOST_CHECK_EQUAL(count.load(), 8u);
+}
@@ -0,0 +1,181 @@
+// This file is part of Blooto.
+//
+// Blooto is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Blooto is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <memory>
+#include <utility>
+#include <boost/lexical_cast.hpp>
+
+#include <blooto/solution.hpp>
+#include <blooto/board.hpp>
+#include <blooto/pawntype.hpp>
+#include <blooto/rooktype.hpp>
+#include <blooto/knighttype.hpp>
+#include <blooto/queentype.hpp>
+#include <blooto/kingtype.hpp>
+#include <blooto/square.hpp>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE test_solution
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(test_solution_list) {
+    using namespace blooto;
+    SolutionArena::Cursor cursor{std::make_shared<SolutionArena>()};
+    const std::shared_ptr<const Board> board{
+        std::make_shared<const Board>(
+            boost::lexical_cast<Board>("White Ka1 Rh1 Black Kf8 Pg7 Ph6")
+        )
+    };
+    const Move m1{RookType::instance, Square::H1, Square::H6, true};
+    const Move m2{PawnType::instance, Square::G7, Square::H6, true};
+    const Move m3{KingType::instance, Square::F8, Square::F7};
+    Solution::list next;
+    next.emplace_back(cursor, m2, Solution::list{});
+    next.emplace_back(cursor, m3, Solution::list{});
+    Solution::list sl;
+    BOOST_CHECK(sl.empty());
+    sl.emplace_back(cursor, m1, std::move(next));
+    BOOST_CHECK(next.empty());
+    sl.board(board);
+    BOOST_REQUIRE_EQUAL(sl.size(), 1u);
+    BOOST_CHECK_EQUAL(sl.begin()->move(), m1);
+    const Solution::list &sl2 = sl.begin()->next();
+    BOOST_REQUIRE_EQUAL(sl2.size(), 2u);
+    auto p = sl2.begin();
+    BOOST_CHECK_EQUAL(p->move(), m2);
+    BOOST_CHECK(p->next().empty());
+    ++p;
+    BOOST_CHECK_EQUAL(p->move(), m3);
+    ++p;
+    BOOST_CHECK(p == sl2.end());
+    Solution::list shared{
+        Solution::list::shared(cursor.arena(), sl2.root())
+    };
+    BOOST_REQUIRE_EQUAL(shared.size(), 2u);
+    BOOST_CHECK_EQUAL(shared.root(), sl2.root());
+    Solution::list sl3;
+    sl3.emplace_back(cursor, m1, std::move(shared));
+    sl3.board(board);
+    BOOST_CHECK_EQUAL(sl3.begin()->next().root(), sl2.root());
+    BOOST_CHECK_EQUAL(sl3.begin()->next().begin()->move(), m2);
+    BOOST_CHECK(Solution::list::shared(cursor.arena(),
+                                       SolutionArena::none).empty());
+    BOOST_CHECK(sl.begin()->threat().empty());
+    Solution::list threat;
+    threat.emplace_back(cursor, m2, Solution::list{});
+    Solution::list sl4;
+    sl4.emplace_back(cursor, m3, Solution::list{}, std::move(threat));
+    BOOST_CHECK(threat.empty());
+    sl4.board(board);
+    BOOST_REQUIRE_EQUAL(sl4.begin()->threat().size(), 1u);
+    BOOST_CHECK_EQUAL(sl4.begin()->threat().begin()->move(), m2);
+    sl4.splice_back(std::move(sl3));
+    BOOST_CHECK(sl3.empty());
+    BOOST_CHECK_EQUAL(sl4.size(), 2u);
+    sl4.emplace_back(cursor, m2, Solution::list{});
+    p = sl4.begin();
+    BOOST_CHECK_EQUAL(p->move(), m3);
+    BOOST_CHECK_EQUAL((++p)->move(), m1);
+    BOOST_CHECK_EQUAL((++p)->move(), m2);
+    Solution::list sl5;
+    sl5.splice_back(std::move(sl4));
+    BOOST_CHECK_EQUAL(sl5.size(), 3u);
+    Solution::list moved{std::move(sl)};
+    BOOST_CHECK(sl.empty());
+    BOOST_CHECK_EQUAL(moved.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(test_solution_arena) {
+    using namespace blooto;
+    std::shared_ptr<SolutionArena> arena{std::make_shared<SolutionArena>()};
+    SolutionArena::Cursor cursor1{arena}, cursor2{arena};
+    const std::shared_ptr<const Board> board{
+        std::make_shared<const Board>(
+            boost::lexical_cast<Board>("White Ka1 Qd1 Sb1 Black Kh8")
+        )
+    };
+    const Move m1{QueenType::instance, Square::D1, Square::D8};
+    const Move m2{KnightType::instance, Square::B1, Square::C3};
+    Solution::list sl1, sl2;
+    // Enough nodes to span several chunks, allocated alternately
+    const unsigned count = 10000;
+    for (unsigned i = 0; i < count; ++i) {
+        sl1.emplace_back(cursor1, m1, Solution::list{});
+        sl2.emplace_back(cursor2, m2, Solution::list{});
+    }
+    BOOST_CHECK_EQUAL(sl1.size(), count);
+    BOOST_CHECK_EQUAL(sl2.size(), count);
+    sl1.board(board);
+    sl2.board(board);
+    for (const auto &solution: sl1)
+        BOOST_CHECK(solution.move() == m1);
+    for (const auto &solution: sl2)
+        BOOST_CHECK(solution.move() == m2);
+    Solution::list sl;
+    sl.emplace_back(cursor1, m2, std::move(sl1));
+    sl.emplace_back(cursor2, m1, std::move(sl2));
+    sl.board(board);
+    arena.reset();
+    BOOST_REQUIRE_EQUAL(sl.size(), 2u);
+    BOOST_CHECK_EQUAL(sl.begin()->next().size(), count);
+    BOOST_CHECK(sl.begin()->next().begin()->move() == m1);
+    BOOST_CHECK_EQUAL(sizeof(SolutionArena::Node), 16u);
+}
+
+BOOST_AUTO_TEST_CASE(test_solution_arena_release) {
+    using namespace blooto;
+    std::shared_ptr<SolutionArena> arena{std::make_shared<SolutionArena>()};
+    SolutionArena::Cursor cursor{arena};
+    const std::shared_ptr<const Board> board{
+        std::make_shared<const Board>(
+            boost::lexical_cast<Board>("White Ka1 Qd1 Black Kh8")
+        )
+    };
+    const Move m{QueenType::instance, Square::D1, Square::D8};
+    Solution::list sl1;
+    sl1.emplace_back(cursor, m, Solution::list{});
+    const SolutionArena::index_type old{sl1.root()};
+    BOOST_CHECK(arena->live(old));
+    sl1 = Solution::list{};
+    arena->release();
+    BOOST_CHECK(!arena->live(old));
+    BOOST_CHECK(arena->live(SolutionArena::none));
+    // The cursor takes a new chunk instead of the freed one
+    Solution::list sl2;
+    sl2.emplace_back(cursor, m, Solution::list{});
+    BOOST_CHECK(arena->live(sl2.root()));
+    sl2.board(board);
+    BOOST_CHECK(sl2.begin()->move() == m);
+}
+
+BOOST_AUTO_TEST_CASE(test_solution_arena_release_many) {
+    using namespace blooto;
+    std::shared_ptr<SolutionArena> arena{std::make_shared<SolutionArena>()};
+    SolutionArena::Cursor cursor{arena};
+    const Move m{QueenType::instance, Square::D1, Square::D8};
+    BOOST_CHECK(!arena->allocated());
+    // Each release after allocation takes a chunk of indices
+    for (unsigned i = 0; i < 100000; ++i) {
+        Solution::list sl;
+        sl.emplace_back(cursor, m, Solution::list{});
+        BOOST_REQUIRE(arena->allocated());
+        sl = Solution::list{};
+        arena->release();
+        BOOST_REQUIRE(!arena->allocated());
+    }
+    Solution::list sl;
+    sl.emplace_back(cursor, m, Solution::list{});
+    BOOST_CHECK(arena->live(sl.root()));
+}
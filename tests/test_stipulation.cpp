@@ -13,7 +13,14 @@
 // You should have received a copy of the GNU General Public License
 // along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
+#include <cstdint>
 #include <initializer_list>
+#include <string>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 #include <boost/lexical_cast.hpp>
 
 #include <blooto/stipulation.hpp>
@@ -24,6 +31,75 @@
 #define BOOST_TEST_MODULE test_stupulation
 #include <boost/test/unit_test.hpp>
 
+static void check_equal(const blooto::Solution::list &sl1,
+                        const blooto::Solution::list &sl2)
+{
+    BOOST_REQUIRE_EQUAL(sl1.size(), sl2.size());
+    auto p2 = sl2.begin();
+    for (const auto &solution: sl1) {
+        BOOST_CHECK(solution.move() == p2->move());
+        check_equal(solution.next(), p2->next());
+        ++p2;
+    }
+}
+
+// Check that the keys are the moves of the solutions, without play after
+static void check_keys(const blooto::Solution::list &keys,
+                       const blooto::Solution::list &sl)
+{
+    BOOST_REQUIRE_EQUAL(keys.size(), sl.size());
+    auto key = keys.begin();
+    for (const auto &solution: sl) {
+        BOOST_CHECK_EQUAL(key->move(), solution.move());
+        BOOST_CHECK(key->next().empty());
+        ++key;
+    }
+}
+
+// Check that solutions and keys streamed one by one are the same
+// as the ones solved at once
+static void check_stream(const blooto::Stipulation &st,
+                         const blooto::Board &board,
+                         const blooto::Solution::list &sl)
+{
+    using blooto::Solution;
+    auto p = sl.begin();
+    BOOST_CHECK_EQUAL(st.solve(board, [&](const Solution &solution) {
+        BOOST_REQUIRE(p != sl.end());
+        BOOST_CHECK_EQUAL(solution.move(), p->move());
+        check_equal(solution.next(), p->next());
+        ++p;
+    }), sl.size());
+    BOOST_CHECK(p == sl.end());
+    p = sl.begin();
+    BOOST_CHECK_EQUAL(st.solve_keys(board, [&](const Solution &solution) {
+        BOOST_REQUIRE(p != sl.end());
+        BOOST_CHECK_EQUAL(solution.move(), p->move());
+        BOOST_CHECK(solution.next().empty());
+        ++p;
+    }), sl.size());
+}
+
+// Solve the problem with the stipulation, set it up with the function
+// and check that it gives the same solutions then
+// @return number of solutions
+template <typename Setup>
+static unsigned check_setup(blooto::Stipulation st,
+                            const std::string &position, Setup setup)
+{
+    using namespace blooto;
+    Board board{st.first_move_colour()};
+    std::istringstream{position} >> board;
+    const Solution::list sl{st.solve(board)};
+    setup(st);
+    check_equal(st.solve(board), sl);
+    BOOST_CHECK_EQUAL(st.exists(board), !sl.empty());
+    BOOST_CHECK_EQUAL(st.count_solutions(board, 0), sl.size());
+    check_keys(st.solve_keys(board), sl);
+    check_stream(st, board, sl);
+    return sl.size();
+}
+
 BOOST_AUTO_TEST_CASE(test_stipulation_directmate) {
     using namespace blooto;
     Stipulation st{Stipulation::directmate(2)};
@@ -387,3 +463,388 @@ BOOST_AUTO_TEST_CASE(test_stipulation_helpmate_2) {
         BOOST_CHECK(p1 == sl1.end());
     }
 }
+
+BOOST_AUTO_TEST_CASE(test_stipulation_threads) {
+    using namespace blooto;
+    Stipulation dm{Stipulation::directmate(3)};
+    dm.threads(4);
+    BOOST_CHECK_EQUAL(dm.threads(), 4);
+    dm.split_depth(2);
+    BOOST_CHECK_EQUAL(dm.split_depth(), 2);
+    dm.hash_size(1);
+    BOOST_CHECK_EQUAL(dm.hash_size(), 1);
+    // The 16 white moves from the initial position are solved
+    // as separate tasks, and so are the moves from positions
+    // with enough steps left
+    Board board{dm.first_move_colour()};
+    std::istringstream{"White Kf8 Rh1 Pg6 Black Kh8 Bg8 Pg7 Ph7"} >> board;
+    BOOST_CHECK_EQUAL(dm.tasks(), 0u);
+    dm.split_depth(5);
+    dm.solve(board);
+    BOOST_CHECK_EQUAL(dm.tasks(), 16u);
+    dm.split_depth(2);
+    dm.solve(board);
+    BOOST_CHECK_GT(dm.tasks(), 16u);
+    dm.threads(1);
+    dm.solve(board);
+    BOOST_CHECK_EQUAL(dm.tasks(), 0u);
+    // Threads find the same solutions, wherever the search is split
+    for (unsigned depth = 1; depth <= 4; ++depth) {
+        auto setup = [=](Stipulation &st) {
+            st.threads(4);
+            st.split_depth(depth);
+        };
+        BOOST_CHECK(check_setup(Stipulation::directmate(3),
+                                "White Kf8 Rh1 Pg6 Black Kh8 Bg8 Pg7 Ph7",
+                                setup) > 0);
+        BOOST_CHECK(check_setup(Stipulation::helpmate(2),
+                                "White Kf3 Re5 Bf8 Ba4 Black Kf6 Pf7 Pd6",
+                                setup) > 0);
+    }
+    check_setup(Stipulation::directmate(3),
+                "White Kf8 Rh1 Pg6 Black Kh8 Bg8 Pg7 Ph7",
+                [](Stipulation &st) {
+                    st.threads(4);
+                    st.hash_size(1);
+                });
+}
+
+BOOST_AUTO_TEST_CASE(test_stipulation_keys) {
+    using namespace blooto;
+    Stipulation st{Stipulation::directmate(3)};
+    Board board{st.first_move_colour()};
+    std::istringstream{"White Kf8 Rh1 Pg6 Black Kh8 Bg8 Pg7 Ph7"} >> board;
+    Solution::list sl{st.solve(board)};
+    // Solutions have play after the keys, which the keys have not
+    BOOST_CHECK(std::any_of(sl.begin(), sl.end(),
+                            [](const Solution &solution) {
+                                return !solution.next().empty();
+                            }));
+    // Exactly the key moves, without play after them
+    auto keys = [](const Solution::list &sl) {
+        std::vector<std::string> moves;
+        for (const auto &solution: sl) {
+            BOOST_CHECK(solution.next().empty());
+            moves.push_back(
+                boost::lexical_cast<std::string>(solution.move())
+            );
+        }
+        return moves;
+    };
+    const std::vector<std::string> dm_keys{"Rh1-h6"};
+    for (unsigned threads: {1, 4}) {
+        st.threads(threads);
+        check_keys(st.solve_keys(board), sl);
+        const std::vector<std::string> found{keys(st.solve_keys(board))};
+        BOOST_CHECK_EQUAL_COLLECTIONS(found.begin(), found.end(),
+                                      dm_keys.begin(), dm_keys.end());
+    }
+    Stipulation hm{Stipulation::helpmate(2)};
+    Board hm_board{hm.first_move_colour()};
+    std::istringstream{"White Kf3 Re5 Bf8 Ba4 Black Kf6 Pf7 Pd6"} >> hm_board;
+    check_keys(hm.solve_keys(hm_board), hm.solve(hm_board));
+    const std::vector<std::string> hm_keys{"Kf6*e5", "Kf6-g6"};
+    const std::vector<std::string> found{keys(hm.solve_keys(hm_board))};
+    BOOST_CHECK_EQUAL_COLLECTIONS(found.begin(), found.end(),
+                                  hm_keys.begin(), hm_keys.end());
+    Stipulation st1{Stipulation::directmate(1)};
+    Board board1{st1.first_move_colour()};
+    std::istringstream{"White Kf8 Rh1 Pg6 Black Kh8 Bg8 Pg7 Ph7"} >> board1;
+    BOOST_CHECK(!st1.exists(board1));
+    BOOST_CHECK(st1.solve_keys(board1).empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_stipulation_stream) {
+    using namespace blooto;
+    // Several keys; solution trees of every key are freed before
+    // the next one, whose solutions reuse the arena and may not use
+    // positions solved before from the transposition table
+    Stipulation st{Stipulation::helpmate(2)};
+    Board board{st.first_move_colour()};
+    std::istringstream{"White Kf3 Re5 Bf8 Ba4 Black Kf6 Pf7 Pd6"} >> board;
+    Solution::list sl{st.solve(board)};
+    BOOST_REQUIRE(sl.size() > 1);
+    for (unsigned threads: {1, 4}) {
+        st.threads(threads);
+        check_stream(st, board, sl);
+        // The first solution comes while solving is still going on,
+        // so the function may stop it there
+        unsigned calls = 0;
+        BOOST_CHECK_THROW(st.solve(board, [&](const Solution &solution) {
+            ++calls;
+            BOOST_CHECK_EQUAL(solution.move(), sl.begin()->move());
+            throw std::runtime_error{"enough"};
+        }), std::runtime_error);
+        BOOST_CHECK_EQUAL(calls, 1u);
+    }
+    Stipulation st1{Stipulation::directmate(1)};
+    Board board1{st1.first_move_colour()};
+    std::istringstream{"White Kf8 Rh1 Pg6 Black Kh8 Bg8 Pg7 Ph7"} >> board1;
+    BOOST_CHECK_EQUAL(st1.solve(board1, [](const Solution &) {
+        BOOST_ERROR("unexpected solution");
+    }), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_stipulation_threats) {
+    using namespace blooto;
+    Stipulation st{Stipulation::directmate(2)};
+    BOOST_CHECK(!st.threats());
+    st.threats(true);
+    BOOST_CHECK(st.threats());
+    Board board{st.first_move_colour()};
+    std::istringstream{"White Kc6 Qb2 Black Ka8"} >> board;
+    st.threats(false);
+    Solution::list sl1{st.solve(board)};
+    st.threats(true);
+    Solution::list sl2{st.solve(board)};
+    check_equal(sl1, sl2);
+    for (const auto &solution: sl1)
+        BOOST_CHECK(solution.threat().empty());
+    std::ostringstream threats;
+    for (const auto &solution: sl2) {
+        threats << solution.move() << ':';
+        for (const auto &threat: solution.threat()) {
+            BOOST_CHECK(threat.next().empty());
+            threats << ' ' << threat.move();
+        }
+        threats << ';';
+    }
+    BOOST_CHECK_EQUAL(threats.str(),
+                      "Kc6-b6: Qb2-h8;"
+                      "Kc6-c7: Qb2-a1 Qb2-a2 Qb2-a3 Qb2-b7 Qb2-b8;"
+                      "Qb2-b1: Qb1-b7;Qb2-b3: Qb3-b7;Qb2-b4: Qb4-b7;"
+                      "Qb2-b5: Qb5-b7;Qb2-b7:;Qb2-g7: Qg7-b7;");
+    Solution::list keys{st.solve_keys(board)};
+    BOOST_REQUIRE_EQUAL(keys.size(), sl2.size());
+    BOOST_CHECK(keys.begin()->next().empty());
+    BOOST_CHECK_EQUAL(keys.begin()->threat().size(), 1u);
+    // Helpmates have no threats
+    Stipulation hm{Stipulation::helpmate(2)};
+    hm.threats(true);
+    BOOST_CHECK(!hm.threats());
+}
+
+BOOST_AUTO_TEST_CASE(test_stipulation_iterate) {
+    using namespace blooto;
+    struct Problem {
+        Stipulation st;
+        std::string board;
+        // Stipulation for given number of half-moves
+        Stipulation (*shorter)(unsigned);
+    };
+    std::initializer_list<Problem> problems{
+        {Stipulation::directmate(3), "White Kc6 Qb2 Black Ka8",
+         [](unsigned half_moves) {
+             return Stipulation::directmate((half_moves + 1) / 2);
+         }},
+        {Stipulation::helpmate(2), "White Kf3 Re5 Bf8 Ba4 Black Kf6 Pf7 Pd6",
+         [](unsigned half_moves) {
+             return Stipulation::helpmate(half_moves / 2);
+         }},
+    };
+    for (const Problem &problem: problems) {
+        Stipulation st{problem.st};
+        Board board{st.first_move_colour()};
+        std::istringstream{problem.board} >> board;
+        for (unsigned threads: {1, 4}) {
+            st.threads(threads);
+            std::vector<std::pair<unsigned, Move>> moves, keys;
+            unsigned fewest = st.solve_iteratively(
+                board,
+                [&](unsigned half_moves, const Solution &solution) {
+                    // Fewer half-moves first
+                    BOOST_CHECK(moves.empty() ||
+                                moves.back().first <= half_moves);
+                    moves.emplace_back(half_moves, solution.move());
+                });
+            BOOST_REQUIRE(!moves.empty());
+            BOOST_CHECK_EQUAL(fewest, moves.front().first);
+            // Solutions in every number of half-moves are the same
+            // as of the stipulation with that many half-moves
+            unsigned full = 0;
+            for (unsigned half_moves = fewest;
+                 half_moves <= moves.back().first; half_moves += 2)
+            {
+                Solution::list sl{problem.shorter(half_moves).solve(board)};
+                for (const auto &solution: sl) {
+                    BOOST_REQUIRE(full < moves.size());
+                    BOOST_CHECK_EQUAL(moves[full].first, half_moves);
+                    BOOST_CHECK_EQUAL(moves[full].second, solution.move());
+                    ++full;
+                }
+            }
+            BOOST_CHECK_EQUAL(full, moves.size());
+            BOOST_CHECK_EQUAL(st.solve_keys_iteratively(
+                board,
+                [&](unsigned half_moves, const Solution &solution) {
+                    BOOST_CHECK(solution.next().empty());
+                    keys.emplace_back(half_moves, solution.move());
+                }), fewest);
+            BOOST_CHECK(keys == moves);
+            std::vector<std::pair<unsigned, Move>> shortest;
+            BOOST_CHECK_EQUAL(st.solve_iteratively(
+                board,
+                [&](unsigned half_moves, const Solution &solution) {
+                    shortest.emplace_back(half_moves, solution.move());
+                }, true), fewest);
+            BOOST_CHECK(!shortest.empty());
+            for (const auto &move: shortest)
+                BOOST_CHECK_EQUAL(move.first, fewest);
+        }
+    }
+    Stipulation st{Stipulation::directmate(1)};
+    Board board{st.first_move_colour()};
+    std::istringstream{"White Kf8 Rh1 Pg6 Black Kh8 Bg8 Pg7 Ph7"} >> board;
+    BOOST_CHECK_EQUAL(st.solve_iteratively(board, [](unsigned,
+                                                      const Solution &) {
+        BOOST_ERROR("unexpected solution");
+    }), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_stipulation_proof_number) {
+    using namespace blooto;
+    Stipulation st{Stipulation::directmate(2)};
+    BOOST_CHECK(!st.proof_number_search());
+    st.proof_number_search(true);
+    BOOST_CHECK(st.proof_number_search());
+    auto setup = [](Stipulation &st) {st.proof_number_search(true);};
+    // Same keys and play as of the usual search
+    BOOST_CHECK(check_setup(Stipulation::directmate(4),
+                            "White Kf6 Qf1 Black Kd8", setup) > 0);
+    BOOST_CHECK(check_setup(Stipulation::directmate(3),
+                            "Neutral Rd4 White Kc6 Qb1 Black Ka8 Pb7",
+                            setup) > 0);
+    BOOST_CHECK_EQUAL(check_setup(Stipulation::directmate(1),
+                                  "White Kf8 Rh1 Pg6 Black Kh8 Bg8 Pg7 Ph7",
+                                  setup), 0u);
+    // With positions of one step solved depth-first, deeper ones
+    // are expanded by proof-number search
+    const unsigned leaf_depth = Stipulation::default_proof_leaf_depth;
+    BOOST_CHECK_EQUAL(st.proof_leaf_depth(), leaf_depth);
+    st.proof_leaf_depth(0);
+    BOOST_CHECK_EQUAL(st.proof_leaf_depth(), 1u);
+    auto deep = [](Stipulation &st) {
+        st.proof_number_search(true);
+        st.proof_leaf_depth(1);
+    };
+    BOOST_CHECK(check_setup(Stipulation::directmate(4),
+                            "White Kf6 Qf1 Black Kd8", deep) > 0);
+    BOOST_CHECK(check_setup(Stipulation::directmate(3),
+                            "Neutral Rd4 White Kc6 Qb1 Black Ka8 Pb7",
+                            deep) > 0);
+    // Proved and disproved at the root after expanding positions
+    auto prove = [&](Stipulation &&st, const std::string &position,
+                     std::uint32_t &work) {
+        deep(st);
+        Board board{st.first_move_colour()};
+        std::istringstream{position} >> board;
+        return st.prove(board, work);
+    };
+    const auto infinity = ProofNumberTable::infinity;
+    std::uint32_t work;
+    ProofNumberTable::Numbers numbers{
+        prove(Stipulation::directmate(2),
+              "White Kf8 Rh1 Pg6 Black Kh8 Bg8 Pg7 Ph7", work)
+    };
+    BOOST_CHECK_EQUAL(numbers.proof, 0u);
+    BOOST_CHECK_EQUAL(numbers.disproof, infinity);
+    BOOST_CHECK_GT(work, 1u);
+    numbers = prove(Stipulation::directmate(3),
+                    "White Kf6 Qf1 Black Kd8", work);
+    BOOST_CHECK_EQUAL(numbers.proof, infinity);
+    BOOST_CHECK_EQUAL(numbers.disproof, 0u);
+    BOOST_CHECK_GT(work, 1u);
+    // With the default leaf depth, the same position is solved
+    // depth-first at once
+    Stipulation dm{Stipulation::directmate(3)};
+    dm.proof_number_search(true);
+    Board board{dm.first_move_colour()};
+    std::istringstream{"White Kf6 Qf1 Black Kd8"} >> board;
+    numbers = dm.prove(board, work);
+    BOOST_CHECK_EQUAL(numbers.disproof, 0u);
+    BOOST_CHECK_EQUAL(work, 1u);
+    Stipulation usual{Stipulation::directmate(3)};
+    BOOST_CHECK_THROW(usual.prove(board, work), std::logic_error);
+    // Proof-number search is only available for directmates
+    Stipulation hm{Stipulation::helpmate(2)};
+    hm.proof_number_search(true);
+    BOOST_CHECK(!hm.proof_number_search());
+}
+
+BOOST_AUTO_TEST_CASE(test_stipulation_intelligent) {
+    using namespace blooto;
+    Stipulation st{Stipulation::helpmate(2)};
+    BOOST_CHECK(!st.intelligent());
+    st.intelligent(true);
+    BOOST_CHECK(st.intelligent());
+    auto setup = [](Stipulation &st) {st.intelligent(true);};
+    // Positions on the way to mates are never skipped
+    BOOST_CHECK(check_setup(Stipulation::helpmate(2),
+                            "White Kf3 Re5 Bf8 Ba4 Black Kf6 Pf7 Pd6",
+                            setup) > 0);
+    check_setup(Stipulation::helpmate(2),
+                "White Ke1 Pb7 Black Kd5 Sc8 Ph2", setup);
+    BOOST_CHECK(check_setup(
+        Stipulation::helpmate_1(1),
+        "White Ph2 Rg3 Ka5 Bb5 Pe7 Black Pe2 Kf2 Qc5 Pe5 Rf7", setup) > 0);
+    check_setup(Stipulation::helpmate(2),
+                "Neutral Pe7 Bd4 White Kg1 Sf3 Black Ke5 Rh8", setup);
+    BOOST_CHECK_EQUAL(check_setup(Stipulation::helpmate(2),
+                                  "White Ka1 Sb1 Black Kh8", setup), 0u);
+    BOOST_CHECK_EQUAL(check_setup(Stipulation::helpmate(3),
+                                  "White Kh1 Bc1 Sg1 Black Ke5 Rd4 Pc5 Pe6",
+                                  setup), 0u);
+    auto feasible = [](Stipulation &&st, const std::string &position) {
+        Board board{st.first_move_colour()};
+        std::istringstream{position} >> board;
+        return st.mate_feasible(board);
+    };
+    BOOST_CHECK(feasible(Stipulation::helpmate(2),
+                         "White Kf3 Re5 Bf8 Ba4 Black Kf6 Pf7 Pd6"));
+    // The knight can't get to the black king in time, and nothing
+    // else may attack it, so the position is skipped, and so is every
+    // position after the first move
+    BOOST_CHECK(!feasible(Stipulation::helpmate(2),
+                          "White Ka1 Sb1 Black Kh8"));
+    for (const char *position: {"White Ka1 Sb1 Black Kg8",
+                                "White Ka1 Sb1 Black Kh7",
+                                "White Ka1 Sb1 Black Kg7"})
+        BOOST_CHECK(!feasible(Stipulation::helpmate_1(1), position));
+    // Mate picture may be reached from the position in three moves
+    // (though there is no mate), but not in one
+    BOOST_CHECK(feasible(Stipulation::helpmate(3),
+                         "White Kh1 Bc1 Sg1 Black Ke5 Rd4 Pc5 Pe6"));
+    BOOST_CHECK(!feasible(Stipulation::helpmate(1),
+                          "White Kh1 Bc1 Sg1 Black Ke5 Rd4 Pc5 Pe6"));
+    // Mate pictures are only looked for in helpmates
+    BOOST_CHECK(feasible(Stipulation::directmate(1),
+                         "White Ka1 Sb1 Black Kh8"));
+    // Intelligent mode is only available for helpmates
+    Stipulation dm{Stipulation::directmate(2)};
+    dm.intelligent(true);
+    BOOST_CHECK(!dm.intelligent());
+}
+
+BOOST_AUTO_TEST_CASE(test_stipulation_count) {
+    using namespace blooto;
+    Stipulation st{Stipulation::helpmate(2)};
+    Board board{st.first_move_colour()};
+    std::istringstream{"White Kf3 Re5 Bf8 Ba4 Black Kf6 Pf7 Pd6"} >> board;
+    unsigned num_solutions = st.solve(board).size();
+    BOOST_REQUIRE(num_solutions > 1);
+    for (unsigned threads: {1, 4}) {
+        st.threads(threads);
+        BOOST_CHECK_EQUAL(st.count_solutions(board, 0), num_solutions);
+        BOOST_CHECK_EQUAL(st.count_solutions(board, 1), 1);
+        BOOST_CHECK_EQUAL(st.count_solutions(board, 2), 2);
+        BOOST_CHECK_EQUAL(st.count_solutions(board, num_solutions + 1),
+                          num_solutions);
+    }
+    Stipulation st1{Stipulation::directmate(1)};
+    Board board1{st1.first_move_colour()};
+    std::istringstream{"White Kf8 Rh1 Pg6 Black Kh8 Bg8 Pg7 Ph7"} >> board1;
+    BOOST_CHECK_EQUAL(st1.count_solutions(board1, 2), 0);
+    Stipulation st3{Stipulation::directmate(3)};
+    BOOST_CHECK_EQUAL(st3.count_solutions(board1, 0), 1);
+    BOOST_CHECK_EQUAL(st3.count_solutions(board1, 2), 1);
+}
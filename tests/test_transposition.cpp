@@ -0,0 +1,120 @@
+// This file is part of Blooto.
+//
+// Blooto is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Blooto is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <blooto/transposition.hpp>
+#include <blooto/board.hpp>
+
+#include <thread>
+#include <vector>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE test_transposition
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(test_transposition) {
+    using namespace blooto;
+    using Outcome = TranspositionTable::Outcome;
+    TranspositionTable table;
+    BOOST_CHECK(table.probe(0x1234, 3) == Outcome::Unknown);
+    table.store(0x1234, 3, Outcome::NotFound);
+    table.store(0x1234, 2, Outcome::Found);
+    BOOST_CHECK(table.probe(0x1234, 3) == Outcome::NotFound);
+    BOOST_CHECK(table.probe(0x1234, 2) == Outcome::Found);
+    BOOST_CHECK(table.probe(0x1234, 1) == Outcome::Unknown);
+    BOOST_CHECK(table.probe(0x4321, 3) == Outcome::Unknown);
+    table.store(0x1234, 3, Outcome::Found);
+    BOOST_CHECK(table.probe(0x1234, 3) == Outcome::Found);
+}
+
+BOOST_AUTO_TEST_CASE(test_transposition_value) {
+    using namespace blooto;
+    using Outcome = TranspositionTable::Outcome;
+    TranspositionTable table;
+    std::uint32_t value = 7;
+    BOOST_CHECK(table.probe(0x1234, 3, value) == Outcome::Unknown);
+    BOOST_CHECK_EQUAL(value, 7u);
+    table.store(0x1234, 3, Outcome::Found, 0xdeadbeef);
+    table.store(0x1234, 2, Outcome::Found);
+    BOOST_CHECK(table.probe(0x1234, 3, value) == Outcome::Found);
+    BOOST_CHECK_EQUAL(value, 0xdeadbeef);
+    BOOST_CHECK(table.probe(0x1234, 2, value) == Outcome::Found);
+    BOOST_CHECK_EQUAL(value, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_transposition_replace) {
+    using namespace blooto;
+    using Outcome = TranspositionTable::Outcome;
+    TranspositionTable table{64};
+    BOOST_CHECK_EQUAL(table.capacity(), 4);
+    table.store(1, 5, Outcome::NotFound);
+    table.store(2, 2, Outcome::NotFound);
+    table.store(3, 7, Outcome::NotFound);
+    table.store(4, 4, Outcome::NotFound);
+    table.store(5, 6, Outcome::Found);
+    BOOST_CHECK(table.probe(1, 5) == Outcome::NotFound);
+    BOOST_CHECK(table.probe(2, 2) == Outcome::Unknown);
+    BOOST_CHECK(table.probe(3, 7) == Outcome::NotFound);
+    BOOST_CHECK(table.probe(4, 4) == Outcome::NotFound);
+    BOOST_CHECK(table.probe(5, 6) == Outcome::Found);
+}
+
+BOOST_AUTO_TEST_CASE(test_transposition_hash) {
+    using namespace blooto;
+    Board board1{
+        {Square::E1, KingType::instance, ColourWhite()},
+        {Square::B1, KnightType::instance, ColourWhite()},
+        {Square::D4, BishopType::instance, ColourNeutral()},
+        {Square::E8, KingType::instance, ColourBlack()},
+    };
+    Board board2{board1};
+    board1.make_move(Square::B1, Square::C3);
+    board2.make_move(Square::B1, Square::D2);
+    BOOST_CHECK(board1.hash() != board2.hash());
+    board1.make_move(Square::C3, Square::E4);
+    board2.make_move(Square::D2, Square::E4);
+    BOOST_CHECK_EQUAL(board1.hash(), board2.hash());
+    board1.make_move(Square::D4, Square::E5);
+    BOOST_CHECK(board1.hash() != board2.hash());
+    board2.make_move(Square::D4, Square::E5);
+    BOOST_CHECK_EQUAL(board1.hash(), board2.hash());
+    board1.flip_colour();
+    BOOST_CHECK(board1.hash() != board2.hash());
+    board2.flip_colour();
+    BOOST_CHECK_EQUAL(board1.hash(), board2.hash());
+}
+
+BOOST_AUTO_TEST_CASE(test_transposition_threads) {
+    using namespace blooto;
+    using Outcome = TranspositionTable::Outcome;
+    TranspositionTable table{1024};
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < 4; ++t)
+        threads.emplace_back([&table, t]() {
+            for (std::uint64_t key = 1; key < 10000; ++key) {
+                Outcome outcome = (key + t) % 2 ? Outcome::Found
+                                                : Outcome::NotFound;
+                table.store(key * 0x9e3779b97f4a7c15, t, outcome);
+            }
+        });
+    for (auto &thread: threads)
+        thread.join();
+    for (unsigned t = 0; t < 4; ++t)
+        for (std::uint64_t key = 1; key < 10000; ++key) {
+            Outcome outcome = table.probe(key * 0x9e3779b97f4a7c15, t);
+            BOOST_CHECK(outcome == Outcome::Unknown ||
+                        outcome == ((key + t) % 2 ? Outcome::Found
+                                                  : Outcome::NotFound));
+        }
+}
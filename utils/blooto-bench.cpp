@@ -0,0 +1,153 @@
+// This file is part of Blooto.
+//
+// Blooto is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Blooto is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include <sstream>
+#include <iostream>
+#include <exception>
+#include <boost/program_options.hpp>
+
+#include <blooto/board.hpp>
+
+// Count legal positions reachable in given number of half-moves,
+// copying the board for every child position
+static std::uint64_t nodes_copy(const blooto::Board &board, unsigned depth) {
+    if (depth == 0)
+        return 1;
+    std::uint64_t nodes = 0;
+    for (const auto &move: board.moves()) {
+        blooto::Board newboard{board};
+        if (move.promotion())
+            newboard.do_move(move.from(), move.to(), *move.promotion());
+        else
+            newboard.do_move(move.from(), move.to());
+        if (!newboard.unfriendly_king_attacked())
+            nodes += nodes_copy(newboard, depth - 1);
+    }
+    return nodes;
+}
+
+// Count legal positions reachable in given number of half-moves,
+// making and taking back moves on the single board
+static std::uint64_t nodes_make_unmake(blooto::Board &board, unsigned depth) {
+    if (depth == 0)
+        return 1;
+    std::uint64_t nodes = 0;
+    for (const auto &move: board.moves()) {
+        const blooto::Board::Undo undo{
+            move.promotion() ?
+            board.do_move(move.from(), move.to(), *move.promotion()) :
+            board.do_move(move.from(), move.to())
+        };
+        if (!board.unfriendly_king_attacked())
+            nodes += nodes_make_unmake(board, depth - 1);
+        board.undo_move(move.from(), move.to(), undo);
+    }
+    return nodes;
+}
+
+// Timings of repeated runs of one way of counting positions
+struct Timings {
+    const char *name;
+    std::uint64_t nodes;
+    std::vector<double> seconds;
+};
+
+template <typename Func>
+static void measure(Timings &timings, Func func) {
+    using clock = std::chrono::steady_clock;
+    const auto start = clock::now();
+    timings.nodes = func();
+    const std::chrono::duration<double> elapsed{clock::now() - start};
+    timings.seconds.push_back(elapsed.count());
+}
+
+static void report(Timings &timings) {
+    std::sort(timings.seconds.begin(), timings.seconds.end());
+    const double best = timings.seconds.front();
+    const double median = timings.seconds[timings.seconds.size() / 2];
+    std::cout << timings.name << ": " << timings.nodes << " nodes, best "
+              << best << " s, median " << median << " s, "
+              << (best > 0 ? timings.nodes / best : 0)
+              << " nodes/s at best\n";
+}
+
+int main(int argc, const char *const *argv) try {
+    namespace po = boost::program_options;
+    using namespace blooto;
+    po::options_description desc("Allowed options");
+    desc.add_options()
+    ("help", "produce help message")
+    ("board,b", po::value<std::string>(), "board content")
+    ("black", "black moves first")
+    ("depth,n", po::value<unsigned>()->default_value(4),
+     "number of half-moves to search")
+    ("repeat,r", po::value<unsigned>()->default_value(5),
+     "number of timed runs of each way")
+    ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+    if (vm.count("help")) {
+        std::cout << desc << "\n";
+        return 1;
+    }
+    std::istringstream istr;
+    std::istream *in;
+    if (vm.count("board")) {
+        istr.str(vm["board"].as<std::string>());
+        in = &istr;
+    } else {
+        in = &std::cin;
+    }
+    Board board{vm.count("black") ? MoveColour{ColourBlack()} :
+                                    MoveColour{ColourWhite()}};
+    *in >> board;
+    if (in->fail()) {
+        std::cerr << "Error reading board." << std::endl;
+        return 1;
+    }
+    const unsigned depth = vm["depth"].as<unsigned>();
+    const unsigned repeat = std::max(vm["repeat"].as<unsigned>(), 1u);
+    auto copy = [&] {return nodes_copy(board, depth);};
+    auto make_unmake = [&] {return nodes_make_unmake(board, depth);};
+    // Both ways are run once untimed to warm up caches and branch
+    // predictors, then in turns, each going first every other time
+    Timings copy_timings{"copy", 0, {}};
+    Timings make_unmake_timings{"make/unmake", 0, {}};
+    copy();
+    make_unmake();
+    for (unsigned i = 0; i < repeat; ++i) {
+        if (i % 2 == 0) {
+            measure(copy_timings, copy);
+            measure(make_unmake_timings, make_unmake);
+        } else {
+            measure(make_unmake_timings, make_unmake);
+            measure(copy_timings, copy);
+        }
+    }
+    report(copy_timings);
+    report(make_unmake_timings);
+    return 0;
+} catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+} catch (...) {
+    std::cerr << "Unknown error!" << std::endl;
+    return 1;
+}
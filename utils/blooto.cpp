@@ -21,32 +21,108 @@
 #include <blooto/solution.hpp>
 #include <blooto/stipulation.hpp>
 
-static void print_solutions(const blooto::Solution::list &sl,
-                            unsigned indent = 0)
+static void print_solution(const blooto::Solution &solution,
+                           unsigned indent = 0)
 {
-    for (const auto &solution: sl) {
-        for (unsigned i = 0; i < indent; i++)
+    for (unsigned i = 0; i < indent; i++)
+        std::cout << "\t";
+    std::cout << solution.move() << "\n";
+    const blooto::Solution::list threat{solution.threat()};
+    if (!threat.empty()) {
+        for (unsigned i = 0; i <= indent; i++)
             std::cout << "\t";
-        std::cout << solution.move() << "\n";
-        print_solutions(solution.next(), indent + 1);
+        std::cout << "threat:\n";
+        for (const auto &next: threat)
+            print_solution(next, indent + 2);
     }
+    for (const auto &next: solution.next())
+        print_solution(next, indent + 1);
 }
 
-static int solve(const blooto::Stipulation &st,
+// Print name of the stipulation for given number of half-moves
+static void print_stipulation(const boost::program_options::variables_map &vm,
+                              unsigned half_moves)
+{
+    if (vm.count("directmate")) {
+        std::cout << "#" << (half_moves + 1) / 2;
+    } else {
+        std::cout << "h#" << half_moves / 2;
+        if (half_moves % 2)
+            std::cout << ".5";
+    }
+    std::cout << ":\n";
+}
+
+static int solve(blooto::Stipulation &&st,
+                 const boost::program_options::variables_map &vm,
                  std::istream &in)
 {
+    if (vm.count("threads"))
+        st.threads(vm["threads"].as<unsigned>());
+    if (vm.count("split-depth"))
+        st.split_depth(vm["split-depth"].as<unsigned>());
+    if (vm.count("hash"))
+        st.hash_size(vm["hash"].as<unsigned>());
+    if (vm.count("threats"))
+        st.threats(true);
+    if (vm.count("proof-number"))
+        st.proof_number_search(true);
+    if (vm.count("intelligent"))
+        st.intelligent(true);
     blooto::Board board{st.first_move_colour()};
     in >> board;
     if (in.fail()) {
         std::cerr << "Error reading board." << std::endl;
         return 1;
     }
-    blooto::Solution::list sl{st.solve(board)};
-    if (sl.empty()) {
+    if (vm.count("count-solutions")) {
+        unsigned limit = vm["count-solutions"].as<unsigned>();
+        unsigned count = st.count_solutions(board, limit);
+        std::cout << "Solutions: " << count;
+        if (count > 0 && count == limit)
+            std::cout << " or more";
+        std::cout << "\n";
+        return count > 0 ? 0 : 1;
+    }
+    if (vm.count("exists")) {
+        if (!st.exists(board)) {
+            std::cerr << "No solutions." << std::endl;
+            return 1;
+        }
+        std::cout << "Solution exists.\n";
+        return 0;
+    }
+    // Print every solution as soon as it is found
+    auto print = [](const blooto::Solution &solution) {
+        print_solution(solution);
+        std::cout.flush();
+    };
+    // Nonzero if there are solutions
+    unsigned found;
+    if (vm.count("iterate") || vm.count("shortest")) {
+        // Print solutions in fewer moves first, each number of moves
+        // preceded by the stipulation it solves
+        unsigned last = 0;
+        auto print_iteration = [&](unsigned half_moves,
+                                   const blooto::Solution &solution) {
+            if (half_moves != last) {
+                print_stipulation(vm, half_moves);
+                last = half_moves;
+            }
+            print(solution);
+        };
+        const bool shortest = vm.count("shortest");
+        found = vm.count("keys-only") ?
+            st.solve_keys_iteratively(board, print_iteration, shortest) :
+            st.solve_iteratively(board, print_iteration, shortest);
+    } else {
+        found = vm.count("keys-only") ?
+            st.solve_keys(board, print) : st.solve(board, print);
+    }
+    if (found == 0) {
         std::cerr << "No solutions." << std::endl;
         return 1;
     }
-    print_solutions(sl);
     return 0;
 }
 
@@ -61,6 +137,20 @@ int main(int argc, const char *const *argv) try {
     ("helpmate+1", po::value<unsigned>(),
      "solve helpmate problem with additional half-move")
     ("board,b", po::value<std::string>(), "board content")
+    ("threads,t", po::value<unsigned>(),
+     "number of threads (0 for all available cores)")
+    ("split-depth", po::value<unsigned>(),
+     "minimal remaining depth for splitting search between threads")
+    ("hash", po::value<unsigned>(), "transposition table size in megabytes")
+    ("keys-only", "print only key moves of solutions")
+    ("threats", "print threats of key moves of directmates")
+    ("proof-number", "use proof-number search for directmates")
+    ("intelligent", "skip helpmate positions with no reachable mate picture")
+    ("iterate", "solve in fewer moves first, printing shorter solutions")
+    ("shortest", "print only solutions in the fewest moves")
+    ("exists", "only check whether solution exists")
+    ("count-solutions", po::value<unsigned>(),
+     "count solutions up to given limit (0 for no limit)")
     ;
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -79,13 +169,13 @@ int main(int argc, const char *const *argv) try {
     }
     if (vm.count("directmate")) {
         return solve(Stipulation::directmate(vm["directmate"].as<unsigned>()),
-                     *in);
+                     vm, *in);
     } else if (vm.count("helpmate")) {
         return solve(Stipulation::helpmate(vm["helpmate"].as<unsigned>()),
-                     *in);
+                     vm, *in);
     } else if (vm.count("helpmate+1")) {
         return solve(Stipulation::helpmate_1(vm["helpmate+1"].as<unsigned>()),
-                     *in);
+                     vm, *in);
     } else {
         std::cerr << "No stipulation specified.";
         return 1;